@@ -0,0 +1,186 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "spsc.h"
+
+// =============================================================================
+// BUTTON INPUT
+// =============================================================================
+// Two capture modes (BUTTON_USE_INTERRUPTS in config.h):
+//   - Interrupt: a CHANGE interrupt pushes microsecond-timestamped edges into
+//     a lock-free queue; update() replays them in order, so taps that happen
+//     while loop() is blocked (FastLED.show(), OTA) keep their real timing.
+//   - Polling: digitalRead() once per update(), as a fallback.
+
+struct ButtonEdge {
+    uint32_t timeUs;   // micros() when the edge was seen
+    uint8_t level;     // Pin level after the edge (HIGH / LOW)
+};
+
+// Single-producer (ISR) / single-consumer (update()) edge queue
+template <uint8_t N>
+using EdgeQueue = SpscQueue<ButtonEdge, N>;
+
+// Button state tracking with double-tap and long-press support
+struct ButtonState {
+    uint8_t pin;
+    bool lastState;
+    bool currentState;
+    unsigned long lastPressTime;
+    unsigned long pendingPressTime;
+    uint32_t tapUs;      // micros() of the edge that started the current tap
+    bool tapped;         // First tap seen (fires at once, before the double-tap window)
+    bool pressed;        // Single press confirmed (after double-tap window)
+    bool doubleTapped;   // Double tap confirmed
+    bool cancelled;      // The window closed with the button held: a hold, not a tap
+    bool pendingPress;   // Waiting to see if double-tap follows
+    bool holdFired;      // Long-press already triggered this hold
+
+#if BUTTON_USE_INTERRUPTS
+    EdgeQueue<BUTTON_EDGE_QUEUE_SIZE> edges;
+    unsigned long lastEdgeTime;   // Last accepted (settled) edge
+    TaskHandle_t wakeTask = nullptr;  // Notified on every edge (frame scheduler)
+#endif
+
+    void begin(uint8_t _pin) {
+        pin = _pin;
+        pinMode(pin, INPUT_PULLUP);
+        lastState = HIGH;
+        currentState = HIGH;
+        lastPressTime = 0;
+        pendingPressTime = 0;
+        tapUs = 0;
+        tapped = false;
+        pressed = false;
+        doubleTapped = false;
+        cancelled = false;
+        pendingPress = false;
+        holdFired = false;
+
+#if BUTTON_USE_INTERRUPTS
+        lastEdgeTime = millis() - BUTTON_SETTLE_MS;
+        attachInterruptArg(digitalPinToInterrupt(pin), onEdge, this, CHANGE);
+#endif
+    }
+
+    void update() {
+        tapped = false;
+        pressed = false;
+        doubleTapped = false;
+        cancelled = false;
+
+#if BUTTON_USE_INTERRUPTS
+        unsigned long now = millis();
+        uint32_t nowUs = micros();
+
+        // Replay queued edges in order. Stop as soon as an event fires so it
+        // is reported this pass; the remaining edges are handled next pass.
+        ButtonEdge e;
+        while (!anyEvent() && edges.peek(e)) {
+            unsigned long t = edgeTime(e, now, nowUs);
+            resolvePending(t);
+            if (anyEvent()) break;
+            edges.pop();
+            applyEdge(e.level, t, e.timeUs);
+        }
+
+        if (!anyEvent()) {
+            // Catch a settled level the queue missed (bounce inside the
+            // settle window, or a dropped edge)
+            if (now - lastEdgeTime >= BUTTON_SETTLE_MS) {
+                uint8_t level = digitalRead(pin);
+                if (level != currentState) applyEdge(level, now, nowUs);
+            }
+            resolvePending(now);
+        }
+#else
+        currentState = digitalRead(pin);
+
+        // Detect falling edge (HIGH -> LOW) with debounce
+        if (currentState == LOW && lastState == HIGH) {
+            registerTap(millis(), micros());
+        }
+        resolvePending(millis());
+
+        lastState = currentState;
+#endif
+    }
+
+    // Any of the one-pass events above fired
+    bool anyEvent() const {
+        return tapped || pressed || doubleTapped || cancelled;
+    }
+
+    bool isHeld() const {
+        return (currentState == LOW);
+    }
+
+    // Long-press detection: returns true once per hold when held >= LONG_PRESS_MS
+    bool longPressed() {
+        if (isHeld() && !holdFired && (millis() - lastPressTime >= LONG_PRESS_MS)) {
+            holdFired = true;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    // A debounced press at time `now` — first tap or second of a double tap
+    void registerTap(unsigned long now, uint32_t nowUs) {
+        if (now - lastPressTime <= DEBOUNCE_MS) return;
+        lastPressTime = now;
+        holdFired = false;
+
+        if (pendingPress && (now - pendingPressTime < DOUBLE_TAP_MS)) {
+            // Second tap within window — double tap
+            doubleTapped = true;
+            pendingPress = false;
+        } else {
+            // First tap — wait for possible second
+            tapped = true;
+            tapUs = nowUs;
+            pendingPress = true;
+            pendingPressTime = now;
+        }
+    }
+
+    // Settle the double-tap window as of time `now`
+    void resolvePending(unsigned long now) {
+        if (!pendingPress || (now - pendingPressTime < DOUBLE_TAP_MS)) return;
+
+        // Still held: it's becoming a long-press, not a tap
+        // Released: single press
+        pressed = !isHeld();
+        cancelled = !pressed;
+        pendingPress = false;
+    }
+
+#if BUTTON_USE_INTERRUPTS
+    void applyEdge(uint8_t level, unsigned long t, uint32_t us) {
+        if (level == currentState) return;
+        if (t - lastEdgeTime < BUTTON_SETTLE_MS) return;  // Contact bounce
+        lastEdgeTime = t;
+        lastState = currentState;
+        currentState = level;
+        if (level == LOW) registerTap(t, us);
+    }
+
+    // Convert an edge's micros() stamp to the millis() timebase
+    static unsigned long edgeTime(const ButtonEdge& e, unsigned long now, uint32_t nowUs) {
+        int32_t ageUs = (int32_t)(nowUs - e.timeUs);
+        if (ageUs < 0) ageUs = 0;   // Edge arrived after nowUs was sampled
+        return now - (unsigned long)(ageUs / 1000);
+    }
+
+    static void IRAM_ATTR onEdge(void *arg) {
+        ButtonState *self = static_cast<ButtonState *>(arg);
+        self->edges.push({(uint32_t)micros(), (uint8_t)digitalRead(self->pin)});
+        if (self->wakeTask) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(self->wakeTask, &woken);
+            if (woken) portYIELD_FROM_ISR();
+        }
+    }
+#endif
+};
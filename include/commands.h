@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "spsc.h"
+
+// =============================================================================
+// TELNET COMMANDS
+// =============================================================================
+// Lines arrive on the network task in DualPrint's fixed line buffer. They are
+// split in place (no copies, no String) and parsed there; anything that
+// changes the game is queued as a GameCommand for the game core, which owns
+// the game and journal.
+
+// A line split into words, pointing into the line buffer
+struct Tokens {
+    uint8_t count = 0;
+    char *word[CMD_MAX_TOKENS];
+
+    // Word i, or "" past the end (so comparisons need no bounds checks)
+    const char *operator[](uint8_t i) const { return i < count ? word[i] : ""; }
+};
+
+// Split `line` on spaces, NUL-terminating each word in place.
+// Words past CMD_MAX_TOKENS are left joined to the last one.
+inline void tokenize(char *line, Tokens& t) {
+    t.count = 0;
+    char *p = line;
+    while (*p && t.count < CMD_MAX_TOKENS) {
+        while (*p == ' ') *p++ = '\0';
+        if (!*p) break;
+        t.word[t.count++] = p;
+        if (t.count == CMD_MAX_TOKENS) break;
+        while (*p && *p != ' ') p++;
+    }
+}
+
+// Parse a decimal number in [0, max]. False on anything else.
+inline bool parseNumber(const char *s, uint16_t max, uint16_t& out) {
+    if (!*s) return false;
+    uint32_t v = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') return false;
+        v = v * 10 + (*s - '0');
+        if (v > max) return false;
+    }
+    out = (uint16_t)v;
+    return true;
+}
+
+enum class GameCommandType : uint8_t {
+    SET_SCORE,      // a-b, history before it can't be undone
+    UNDO,           // Pop the last journal event
+    SET_SERVER,     // Make player a serve now (swaps the first server)
+    RESET,          // Same as a long press
+    SET_RULES,      // New game under RuleSet a (between games only)
+    RESET_MATCH     // Clear the finished-game totals (MatchStats)
+};
+
+struct GameCommand {
+    GameCommandType type;
+    uint8_t a;
+    uint8_t b;
+};
+
+// Network task -> game core
+typedef SpscQueue<GameCommand, CMD_QUEUE_SIZE> GameCommandQueue;
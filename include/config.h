@@ -13,6 +13,25 @@
 #define BUTTON_PLAYER1_PIN  15    // Player 1 (left side) button — Q1 on QuinLED Dig-Uno v3
 #define BUTTON_PLAYER2_PIN  12    // Player 2 (right side) button — Q2 on QuinLED Dig-Uno v3
 
+// Second table on the same board (TABLE_COUNT 2). Its strip takes the LED2
+// output (so neither strip has a backup data line) and its buttons the Q3/Q4
+// pads. Each strip gets its own RMT channel and both are clocked out at once,
+// so a frame costs one strip's wire time. Needs FASTLED_RMT_MAX_CHANNELS >= 2.
+// Pins as on the Dig-Uno v3 pinout (LED1 16, LED2 3, Q1-Q4 15/12/13/2). The
+// board routes LED2 to GPIO3, the UART0 RX pin: usable because Serial is
+// never started (see netlog.h), so don't enable Serial with two tables.
+#define TABLE_COUNT         1     // Tables driven by this controller (1 or 2)
+#define LED2_DATA_PIN       3     // LED2 output on QuinLED Dig-Uno v3 (GPIO3 = U0RXD)
+#define BUTTON2_PLAYER1_PIN 13    // Table 2 Player 1 — Q3 on QuinLED Dig-Uno v3
+#define BUTTON2_PLAYER2_PIN 2     // Table 2 Player 2 — Q4 on QuinLED Dig-Uno v3 (strapping pin, only read at reset)
+
+#if TABLE_COUNT < 1 || TABLE_COUNT > 2
+#error "TABLE_COUNT must be 1 or 2"
+#endif
+#if defined(FASTLED_RMT_MAX_CHANNELS) && FASTLED_RMT_MAX_CHANNELS < TABLE_COUNT
+#error "Each table needs its own RMT channel (raise FASTLED_RMT_MAX_CHANNELS)"
+#endif
+
 // =============================================================================
 // LED STRIP CONFIGURATION
 // =============================================================================
@@ -24,6 +43,13 @@
 #define TOTAL_LEDS          144       // 144 LEDs/m, 1m strip
 #define BRIGHTNESS          80        // 0-255, start conservative
 
+// Power governor (LedFrame in display.h): every frame's LED current is
+// estimated from the pixels sent, and the brightness scaled down for that
+// frame if it would exceed the budget. Size the 12V supply for the budget.
+#define POWER_BUDGET_MA       1500      // All strips on this controller (0 = no limit)
+#define POWER_MA_PER_CHANNEL  5         // WS2815: ~5 mA per color at full (15 mA white)
+#define POWER_IDLE_MA_PER_LED 1         // Quiescent draw per pixel, even when black
+
 // How many LEDs per player side for scoring (21 points with gaps = 41 LEDs)
 #define SCORE_LEDS_PER_SIDE 41
 
@@ -46,13 +72,30 @@
 // P2 serve indicator = LED index (TOTAL_LEDS - SCORE_LEDS_PER_SIDE - 1)
 
 // =============================================================================
-// GAME RULES - 21 point classic
+// GAME RULES
 // =============================================================================
+// Both rule sets are compiled in (rules.h); pick one at 0-0 by holding both
+// buttons for LONG_PRESS_MS, or with `rules 11|21` over telnet.
+
+// 21 point classic (the default)
 #define POINTS_TO_WIN       21
 #define SERVE_SWITCH_EVERY  5     // Switch serve every 5 points normally
 #define DEUCE_SERVE_SWITCH  2     // Switch serve every 2 points at deuce (20-20+)
 #define DEUCE_THRESHOLD     20    // When both players reach this, deuce rules apply
 #define WIN_BY              2     // Must win by 2 after deuce
+#define TRAILING_SERVES     1     // Trailing player serves at game point / deuce advantage
+
+// 11 point ITTF
+#define ITTF_POINTS_TO_WIN      11
+#define ITTF_SERVE_SWITCH_EVERY 2
+#define ITTF_DEUCE_SERVE_SWITCH 1 // Alternate every point from 10-10
+#define ITTF_DEUCE_THRESHOLD    10
+#define ITTF_WIN_BY             2
+#define ITTF_TRAILING_SERVES    0 // Serve order never depends on who leads
+
+// Point journal (undo / replay): 2 bytes per event, static RAM
+#define JOURNAL_CAPACITY    128   // Events kept; older ones fold into a base score
+#define JOURNAL_TICK_MS     100   // Timestamp resolution
 
 // =============================================================================
 // BUTTON DEBOUNCE
@@ -61,6 +104,16 @@
 #define DOUBLE_TAP_MS       400   // Window for double-tap detection
 #define LONG_PRESS_MS       3000  // Hold either button this long to reset
 
+// Speculative scoring: a tap scores on its first edge instead of after
+// DOUBLE_TAP_MS, and is taken back if it turns into a double tap or a hold
+#define SPECULATIVE_TAPS    1
+
+// Input capture: 1 = GPIO interrupts queue timestamped edges (taps are timed
+// correctly even while loop() is blocked), 0 = poll once per loop()
+#define BUTTON_USE_INTERRUPTS   1
+#define BUTTON_SETTLE_MS        20    // Ignore contact bounce this long after an edge
+#define BUTTON_EDGE_QUEUE_SIZE  32    // Queued edges per button (power of 2)
+
 // =============================================================================
 // SCORE COLORS - each group of 5 points gets a distinct color
 // =============================================================================
@@ -73,6 +126,7 @@ const CRGB SCORE_COLORS[] = {
     CRGB::Red              // Point  21 (game point!)
 };
 #define NUM_SCORE_COLORS (sizeof(SCORE_COLORS) / sizeof(SCORE_COLORS[0]))
+#define POINTS_PER_COLOR    5     // Points per color group
 
 // Serve indicator color
 #define SERVE_COLOR         CRGB::White
@@ -95,6 +149,82 @@ const CRGB SCORE_COLORS[] = {
 // Animation timing
 #define SERVE_PULSE_SPEED   3     // Speed of serve indicator pulse (lower = faster)
 #define ANIMATION_SPEED_MS  50    // Frame delay for animations
+#define SERVE_SWEEP_MS      1500  // Serve change comet, old server to new
+#define VICTORY_ANIM_MS     8000  // Victory animation length
+#define VICTORY_HUE_PER_LED   7   // Victory rainbow hue step along the strip (odd)
+#define VICTORY_HUE_PER_FRAME 8   // Victory rainbow hue shift per frame
+#define VICTORY_RAINBOW_VAL   200 // Victory rainbow brightness (HSV value)
+#define STARTUP_WIPE_MS     10    // Startup rainbow: ms per LED lit
+#define STARTUP_HOLD_MS     500   // Startup rainbow: hold before fading
+#define STARTUP_FADE_MS     15    // Startup rainbow: ms per fade step
+
+// Score changes queued for incremental rendering between frames
+#define RENDER_QUEUE_SIZE   16
+
+// Effects (effects.h) layered over the score at once
+#define EFFECT_SLOTS        4
+
+// =============================================================================
+// TASK LAYOUT
+// =============================================================================
+// Input, game logic and LED rendering run in Arduino's loop() on core 1.
+// WiFi, OTA and telnet run in a separate task pinned to core 0 (alongside the
+// ESP32 WiFi stack); the game is handed over through a lock-free snapshot.
+
+#define NET_CORE            0
+#define NET_TASK_STACK      4096  // Bytes
+#define NET_TASK_PRIORITY   1
+#define NET_TASK_PERIOD_MS  5     // Network service interval
+
+// LED output (ledtask.h): frames are clocked out by a task on the game core
+// that sleeps while the RMT hardware sends, so the loop keeps running.
+#define LED_ASYNC_SHOW      1     // 0 = FastLED.show() inline in the game loop
+#define LED_TASK_CORE       1     // Same core as loop()
+#define LED_TASK_STACK      2048  // Bytes
+#define LED_TASK_PRIORITY   2     // Above loop() so a handed-off frame starts at once
+
+// =============================================================================
+// FRAME SCHEDULING
+// =============================================================================
+// The game loop runs on a fixed timestep per state instead of a flat delay.
+// Button edges wake it early, so slow rates don't add input latency.
+
+#define FRAME_IDLE_MS       50    // 0-0 / final score / OTA: slow serve pulse
+#define FRAME_PLAYING_MS    33    // Steady play (~30 fps), woken by input
+#define FRAME_ANIM_MS       ANIMATION_SPEED_MS  // Serve change / victory / startup
+#define SCHED_REPORT_MS     60000 // Log loop jitter stats this often
+
+// =============================================================================
+// IDLE SLEEP
+// =============================================================================
+// After this long on idle frames (0-0 or final score, no buttons), the strips
+// go dark and the chip light-sleeps until a button press (idlesleep.h).
+
+#define IDLE_SLEEP_MS       (10UL * 60 * 1000)  // 0 = never sleep
+#define IDLE_SLEEP_SLICE_MS 1000  // Max light sleep before waking for WiFi / telnet
+#define IDLE_SLEEP_AWAKE_MS 20    // Awake time between slices for the network task
+
+// =============================================================================
+// LATENCY BENCHMARK
+// =============================================================================
+// Edge-to-photon timing, compiled in with -D PINGPONG_LATENCY_BENCH
+// (env:esp32-latency, see latency.h).
+
+#define LATENCY_PENDING          8     // Points between commit and photon at once
+#define LATENCY_INJECT_PIN       -1    // Spare GPIO wired to the P1 button pin (-1 = no self-test)
+#define LATENCY_INJECT_PERIOD_MS 1000  // Self-test press interval (> DOUBLE_TAP_MS: single taps)
+#define LATENCY_INJECT_HOLD_MS   60    // Self-test press length
+
+// =============================================================================
+// GAME PERSISTENCE
+// =============================================================================
+// The point journal is kept in RTC memory (every change) and NVS flash
+// (after the score settles), and restored on boot.
+
+#define PERSIST_QUIET_MS      2000        // Commit to NVS after this long with no change
+#define PERSIST_NVS_NAMESPACE "pingpong"
+#define PERSIST_NVS_KEY       "match"
+#define PERSIST_VERSION       1           // Bump when MatchImage / journal layout changes
 
 // =============================================================================
 // WIFI & OTA CONFIGURATION
@@ -102,9 +232,65 @@ const CRGB SCORE_COLORS[] = {
 // Credentials are loaded from secrets.h (not tracked in git).
 // Copy secrets.h.example to secrets.h and fill in your values.
 
+#define OTA_PROGRESS_STEP   10    // Log OTA progress every this many percent
+
 // =============================================================================
 // TELNET SERIAL MONITOR
 // =============================================================================
 #define TELNET_PORT         23
+#define LOG_BUFFER_SIZE     4096  // Log ring buffer bytes (power of 2)
+#define LOG_DRAIN_CHUNK     512   // Max bytes per telnet write
+#define LOG_FORMAT_MAX      192   // Longest printf() line (formatted on the stack)
+#define TELNET_MAX_CLIENTS  3     // Simultaneous telnet sessions
+#define TELNET_CLIENT_BUFFER 2048 // Per-client output ring bytes (power of 2)
+#define TELNET_STALL_MS     5000  // Disconnect a client whose socket takes nothing this long
+#define TELNET_LINE_MAX     64    // Longest command line accepted
+#define TELNET_READ_BUDGET  64    // Max input bytes read per network task pass
+#define TELNET_SLICE_US     2000  // Max time reading + parsing commands per pass
+#define CMD_MAX_TOKENS      4     // Words per command line
+#define CMD_QUEUE_SIZE      8     // Game commands queued for the game core (power of 2)
+#define CMD_MAX_SCORE       99    // Highest score `set` accepts
+
+// =============================================================================
+// UDP STATE STREAM
+// =============================================================================
+// Binary StatePacket (statepacket.h) multicast on every change + heartbeat
+#define UDP_STATE_GROUP     239, 80, 80, 1  // Multicast group (IPAddress octets)
+#define UDP_STATE_PORT      4280
+#define UDP_HEARTBEAT_MS    1000  // Resend unchanged state this often
+#define UDP_METRICS_PORT    4281  // MetricsPacket (heap / stacks), same group
+
+// =============================================================================
+// MEMORY TELEMETRY
+// =============================================================================
+// Heap and task stack headroom (memstats.h), logged and multicast
+#define MEM_REPORT_MS       60000 // Sample + report this often
+#define MEM_MAX_TASKS       4     // Tasks whose stack high-water mark is tracked
+
+// =============================================================================
+// WEB DASHBOARD
+// =============================================================================
+// Scoreboard page + Server-Sent Events stream (webview.h)
+#define WEB_PORT            80
+#define WEB_MAX_CLIENTS     8     // Open connections (lwIP has ~16 sockets in all)
+#define WEB_EVENT_SIZE      512   // Serialized state event bytes (all tables)
+#define WEB_REQUEST_LINE_MAX 64   // Request line bytes kept for routing
+#define WEB_READ_BUDGET     256   // Max request bytes read per client per pass
+#define WEB_STALL_MS        5000  // Drop a client that sends / takes nothing this long
+#define WEB_KEEPALIVE_MS    15000 // Comment line to idle streams this often
+
+// =============================================================================
+// MIRROR DISPLAYS
+// =============================================================================
+// Extra strips driven by their own ESP32 (env:esp32-mirror, src/mirror.cpp),
+// fed by ESP-NOW broadcast from the primary (mirror.h, mirrorlink.h)
+#define MIRROR_ENABLED      1     // Primary broadcasts every table's changes
+#define MIRROR_STANDALONE   0     // 1 = no access point: skip WiFi, stay on MIRROR_CHANNEL
+#define MIRROR_CHANNEL      0     // WiFi channel; 0 = mirrors scan 1-13 (standalone primary: 1)
+#define MIRROR_KEYFRAME_MS  500   // Resend unchanged state this often
+#define MIRROR_TABLE        0     // Mirror build: which of the primary's tables to show
+#define MIRROR_SCAN_MS      1200  // Mirror build: listen this long per channel when lost (> 2 keyframes)
+#define MIRROR_LOST_MS      3000  // Mirror build: start scanning after this much silence
+#define MIRROR_QUEUE_SIZE   8     // Mirror build: packets waiting for the frame loop (power of 2)
 
 #include "secrets.h"
@@ -3,25 +3,215 @@
 #include <FastLED.h>
 #include "config.h"
 #include "game.h"
+#include "tables.h"
+#include "renderops.h"
+#include "profiler.h"
+#include "latency.h"
+#include "effects.h"
 
 // =============================================================================
 // LED DISPLAY
 // =============================================================================
 
+// Rendering is dirty-tracked: render functions mark the pixels they touch,
+// and show() only clocks a frame out to the strip when a marked pixel (or the
+// global brightness) actually differs from the last frame sent. The static
+// score layer is patched from the game's render ops (see renderops.h), so a
+// point touches one or two pixels. It is only rebuilt from scratch after a
+// reset, an animation, or a lost op; steady play just refreshes the serve
+// pulse pixel.
+
+// =============================================================================
+// LedFrame — one FastLED.show() per frame for every strip
+// =============================================================================
+// With several tables on one controller, each display's show() only flags
+// that its strip changed while a frame is open. endFrame() then calls
+// FastLED.show() once, and the ESP32 RMT driver clocks all strips out in
+// parallel (one RMT channel each), so two tables cost one strip's wire time.
+// Outside beginFrame() / endFrame() a show() is sent immediately.
+//
+// It also governs power. Each display keeps the R+G+B sum of the frame it
+// last sent, updated over the dirty span only, and adds the change to a
+// running total. Before sending, the estimate at the current brightness is
+// checked against POWER_BUDGET_MA and, if over, the frame goes out at a
+// lower scale via FastLED.show(scale). FastLED's own power limiting would
+// rescan every pixel of every strip on each show().
+//
+// Double buffering: leds[] is the back buffer the renderers draw into; the
+// strip is clocked out of _shown (the front buffer, registered with
+// FastLED). show() copies the changed span front-ward and LedFrame hands
+// the frame to an output task (ledtask.h) if one is installed, so the game
+// loop renders and reads buttons while RMT sends. The front buffer is only
+// written once the previous transmission is done (waitIdle()).
+
+class LedFrame {
+public:
+    static void beginFrame() {
+        _open = true;
+        _pending = false;
+    }
+
+    static void endFrame() {
+        _open = false;
+        if (_pending) send();
+        _pending = false;
+    }
+
+    // A strip changed: send now, or with the rest of the frame
+    static void request() {
+        if (_open) _pending = true;
+        else send();
+    }
+
+    // Asynchronous output: `transmit` starts sending at `scale` and returns,
+    // `waitIdle` blocks until the strips are free. Unset = FastLED.show().
+    typedef void (*TransmitFn)(uint8_t scale);
+    typedef void (*WaitIdleFn)();
+
+    static void setOutput(TransmitFn transmit, WaitIdleFn waitIdle) {
+        _transmit = transmit;
+        _waitIdle = waitIdle;
+    }
+
+    // Before writing a front buffer: let the frame in flight finish
+    static void waitIdle() {
+        if (_waitIdle) _waitIdle();
+    }
+
+    // A strip's sent-frame channel sum changed by `delta`
+    static void addLoad(int32_t delta) { _load += delta; }
+
+    // Sum of R+G+B over the last frame of every strip
+    static uint32_t load() { return _load; }
+
+    // Estimated LED current for the current frames at brightness `scale`
+    static uint32_t estimateMa(uint8_t scale) {
+        return IDLE_MA + (uint32_t)((uint64_t)_load * POWER_MA_PER_CHANNEL * scale / (255 * 255));
+    }
+
+    // Last frame sent: estimated draw and the brightness it went out at
+    static uint32_t lastMa() { return _lastMa; }
+    static uint32_t peakMa() { return _peakMa; }
+    static uint8_t lastScale() { return _lastScale; }
+    static uint32_t limitedFrames() { return _limited; }
+    static void resetPeak() { _peakMa = _lastMa; }
+
+private:
+    static const uint32_t IDLE_MA = (uint32_t)TABLE_COUNT * TOTAL_LEDS * POWER_IDLE_MA_PER_LED;
+
+    static inline bool _open = false;
+    static inline bool _pending = false;
+    static inline uint32_t _load = 0;
+    static inline uint32_t _lastMa = 0;
+    static inline uint32_t _peakMa = 0;
+    static inline uint8_t _lastScale = 0;
+    static inline uint32_t _limited = 0;
+    static inline TransmitFn _transmit = nullptr;
+    static inline WaitIdleFn _waitIdle = nullptr;
+
+    static void send() {
+        PROFILE_SCOPE(LED_SHOW);
+        uint8_t scale = governedScale(FastLED.getBrightness());
+        _lastMa = estimateMa(scale);
+        if (_lastMa > _peakMa) _peakMa = _lastMa;
+        _lastScale = scale;
+        LATENCY_FRAME_SENT();
+        if (_transmit) {
+            _transmit(scale);
+        } else {
+            FastLED.show(scale);
+            LATENCY_FRAME_DONE();
+        }
+    }
+
+    // Highest scale <= `scale` that keeps the estimate within budget
+    static uint8_t governedScale(uint8_t scale) {
+        if (POWER_BUDGET_MA == 0 || estimateMa(scale) <= POWER_BUDGET_MA) return scale;
+        _limited++;
+        if (POWER_BUDGET_MA <= IDLE_MA) return 0;
+        uint64_t fit = (uint64_t)(POWER_BUDGET_MA - IDLE_MA) * (255 * 255) /
+                       ((uint64_t)_load * POWER_MA_PER_CHANNEL);
+        return (fit < scale) ? (uint8_t)fit : scale;
+    }
+};
+
 class ScoreDisplay {
 public:
     CRGB leds[TOTAL_LEDS];
 
+    // One instance per strip; PIN picks the (compile-time) RMT data pin.
+    // FastLED sends from the front buffer, renderers draw into leds[].
+    template <uint8_t PIN = LED_DATA_PIN>
     void begin() {
-        FastLED.addLeds<LED_TYPE, LED_DATA_PIN, COLOR_ORDER>(leds, TOTAL_LEDS)
+        FastLED.addLeds<LED_TYPE, PIN, COLOR_ORDER>(_shown, TOTAL_LEDS)
             .setCorrection(TypicalLEDStrip);
         FastLED.setBrightness(BRIGHTNESS);
+        buildVictoryRing();
         clearAll();
-        FastLED.show();
+        forceShow();
     }
 
     void clearAll() {
         fill_solid(leds, TOTAL_LEDS, BG_COLOR);
+        markAllDirty();
+        _servePlayer = NO_PLAYER;
+        _effects.reset();      // Animations re-register every frame
+    }
+
+    // Queue for GameCore::renderOps
+    ScoreRenderQueue& renderQueue() { return _ops; }
+
+    // =========================================================================
+    // DIRTY TRACKING
+    // =========================================================================
+
+    // Flag a single pixel as possibly changed since the last show()
+    void markDirty(int idx) {
+        if (idx < 0 || idx >= TOTAL_LEDS) return;
+        if (idx < _dirtyLo) _dirtyLo = idx;
+        if (idx + 1 > _dirtyHi) _dirtyHi = idx + 1;
+    }
+
+    // Flag the whole strip, and drop the cached score layer (something other
+    // than the layer renderers drew into leds[])
+    void markAllDirty() {
+        _dirtyLo = 0;
+        _dirtyHi = TOTAL_LEDS;
+        _layer = Layer::NONE;
+    }
+
+    // Send the frame only if it differs from what the strip is showing.
+    // Returns true if a frame was actually sent.
+    bool show() {
+        uint8_t brightness = FastLED.getBrightness();
+        bool changed = (brightness != _shownBrightness);
+
+        if (_dirtyLo < _dirtyHi) {
+            size_t bytes = (_dirtyHi - _dirtyLo) * sizeof(CRGB);
+            if (memcmp(&leds[_dirtyLo], &_shown[_dirtyLo], bytes) != 0) {
+                LedFrame::waitIdle();
+                int32_t before = channelSum(_dirtyLo, _dirtyHi);
+                memcpy(&_shown[_dirtyLo], &leds[_dirtyLo], bytes);
+                trackLoad(_shownLoad - before + channelSum(_dirtyLo, _dirtyHi));
+                changed = true;
+            }
+        }
+        clearDirty();
+
+        if (!changed) return false;
+        LedFrame::request();
+        _shownBrightness = brightness;
+        return true;
+    }
+
+    // Send the frame unconditionally (e.g. after the strip was driven elsewhere)
+    void forceShow() {
+        LedFrame::waitIdle();
+        memcpy(_shown, leds, sizeof(leds));
+        trackLoad(channelSum(0, TOTAL_LEDS));
+        clearDirty();
+        LedFrame::request();
+        _shownBrightness = FastLED.getBrightness();
     }
 
     // =========================================================================
@@ -31,37 +221,38 @@ public:
     // Get the color for a given point number (1-based)
     CRGB colorForPoint(uint8_t pointNum) {
         if (pointNum == 0) return BG_COLOR;
-        uint8_t groupIndex = (pointNum - 1) / 5;
-        if (groupIndex >= NUM_SCORE_COLORS) groupIndex = NUM_SCORE_COLORS - 1;
-        return SCORE_COLORS[groupIndex];
+        if (pointNum > tables::MAX_SCORE_POSITIONS) pointNum = tables::MAX_SCORE_POSITIONS;
+        return SCORE_COLORS[tables::POINT_COLOR.group[pointNum - 1]];
     }
 
     // Render a player's score on the strip
     // Player 0 (left):  LEDs grow from index 0 inward
     // Player 1 (right): LEDs grow from index (TOTAL_LEDS-1) inward
-    void renderScore(const PingPongGame& game) {
+    void renderScore(const GameCore& game) {
+        PROFILE_SCOPE(RENDER_SCORE);
+        markAllDirty();
+
         // Clear score areas first
         for (int i = 0; i < SCORE_LEDS_PER_SIDE; i++) {
             leds[i] = BG_COLOR;
             leds[TOTAL_LEDS - 1 - i] = BG_COLOR;
         }
 
-        // Player 1 score (left side, growing right from edge, every other LED)
-        for (int i = 0; i < game.score[0] && P1_LED_OFFSET + i * 2 <= SCORE_LEDS_PER_SIDE; i++) {
-            leds[P1_LED_OFFSET + i * 2] = colorForPoint(i + 1);
-        }
-
-        // Player 2 score (right side, growing left from edge, every other LED)
-        for (int i = 0; i < game.score[1] && i * 2 < SCORE_LEDS_PER_SIDE; i++) {
-            leds[TOTAL_LEDS - 1 - (i * 2)] = colorForPoint(i + 1);
+        // Every other LED, growing inward from each edge (see tables.h)
+        for (uint8_t p = 0; p < 2; p++) {
+            uint8_t n = game.score[p];
+            if (n > tables::SCORE_POSITIONS[p]) n = tables::SCORE_POSITIONS[p];
+            for (uint8_t i = 0; i < n; i++) {
+                leds[tables::SCORE_PIXEL.index[p][i]] = SCORE_COLORS[tables::POINT_COLOR.group[i]];
+            }
         }
 
         // Deuce advantage: show a single advantage LED on the leading player's gap side
         if (game.isDeuce()) {
             if (game.score[0] > game.score[1]) {
-                leds[P1_LED_OFFSET + SCORE_LEDS_PER_SIDE + 2] = DEUCE_ADV_COLOR;  // Spaced past P1 serve
+                leds[tables::ADVANTAGE_PIXEL[0]] = DEUCE_ADV_COLOR;  // Spaced past P1 serve
             } else if (game.score[1] > game.score[0]) {
-                leds[TOTAL_LEDS - SCORE_LEDS_PER_SIDE - 3] = DEUCE_ADV_COLOR;  // LED 100, spaced past P2 serve
+                leds[tables::ADVANTAGE_PIXEL[1]] = DEUCE_ADV_COLOR;  // Spaced past P2 serve
             }
         }
     }
@@ -71,24 +262,20 @@ public:
     // =========================================================================
 
     // Pulse a serve indicator LED just outside the score area
-    void renderServeIndicator(const PingPongGame& game) {
-        // Serve indicator positions: just past the score area on each side
-        int p1ServeIdx = P1_LED_OFFSET + SCORE_LEDS_PER_SIDE;   // First LED past P1's score
-        int p2ServeIdx = TOTAL_LEDS - SCORE_LEDS_PER_SIDE - 1; // First LED past P2's score
+    void renderServeIndicator(const GameCore& game) {
+        PROFILE_SCOPE(RENDER_SERVE);
 
-        // Clear both serve indicators
-        if (p1ServeIdx < TOTAL_LEDS) leds[p1ServeIdx] = BG_COLOR;
-        if (p2ServeIdx >= 0)         leds[p2ServeIdx] = BG_COLOR;
+        // Normally already moved by a SERVE op
+        if (game.servingPlayer != _servePlayer) moveServe(game.servingPlayer);
 
         // Pulse the active server's indicator
         uint8_t pulse = beatsin8(60 / SERVE_PULSE_SPEED, 40, 255);
         CRGB serveCol = SERVE_COLOR;
         serveCol.nscale8(pulse);
 
-        if (game.servingPlayer == 0 && p1ServeIdx < TOTAL_LEDS) {
-            leds[p1ServeIdx] = serveCol;
-        } else if (game.servingPlayer == 1 && p2ServeIdx >= 0) {
-            leds[p2ServeIdx] = serveCol;
+        if (game.servingPlayer <= 1) {
+            leds[tables::SERVE_PIXEL[game.servingPlayer]] = serveCol;
+            markDirty(tables::SERVE_PIXEL[game.servingPlayer]);
         }
     }
 
@@ -96,99 +283,128 @@ public:
     // ANIMATIONS
     // =========================================================================
 
-    // Serve change animation: single dot with trail sweeps across full strip
+    // Serve change animation: a comet sweeps from the old server's serve LED
+    // to the new one's, over the score (fx::SERVE_SWEEP).
     // Returns true when animation is complete
-    bool animateServeChange(const PingPongGame& game) {
-        unsigned long elapsed = millis() - game.animStartTime;
-        int totalFrames = 30;  // ~1.5 seconds at 50ms/frame
-        int frame = elapsed / ANIMATION_SPEED_MS;
-
-        if (frame >= totalFrames) return true;  // Animation done
-
-        clearAll();
-        renderScore(game);
-
-        // Serve indicator positions
-        int p1ServeIdx = P1_LED_OFFSET + SCORE_LEDS_PER_SIDE;  // LED past P1's score
-        int p2ServeIdx = TOTAL_LEDS - SCORE_LEDS_PER_SIDE - 1; // LED 122
-
-        // Sweep from old server's serve LED to new server's serve LED
-        int startIdx = (game.servingPlayer == 1) ? p1ServeIdx : p2ServeIdx;
-        int endIdx   = (game.servingPlayer == 1) ? p2ServeIdx : p1ServeIdx;
-        int sweepPos = map(frame, 0, totalFrames - 1, startIdx, endIdx);
-
-        // 10-LED chase trail behind the sweep direction
-        int trailDir = (startIdx < endIdx) ? -1 : 1;
-        for (int t = 0; t < 10; t++) {
-            int idx = sweepPos + (t * trailDir);
-            if (idx >= 0 && idx < TOTAL_LEDS) {
-                uint8_t brightness = 255 - (t * 25);
-                leds[idx] = SERVE_ANIM_COLOR;
-                leds[idx].nscale8(brightness);
-            }
+    bool animateServeChange(const GameCore& game) {
+        PROFILE_SCOPE(ANIM_SERVE_CHANGE);
+        unsigned long now = millis();
+        if (now - game.animStartTime >= fx::SERVE_SWEEP.durationMs) {
+            stopEffects();
+            return true;
         }
 
-        FastLED.show();
+        beginEffects();
+        if (!updateScoreLayer(Layer::PLAYING, game)) {
+            clearAll();
+            renderScore(game);
+            setLayer(Layer::PLAYING, game);
+        }
+        uint8_t server = game.servingPlayer & 1;
+        _effects.play(fx::SERVE_SWEEP, game.animStartTime,
+                      EffectTarget::path(tables::SERVE_PIXEL[1 - server], tables::SERVE_PIXEL[server]));
+        endEffects(now);
+        show();
         return false;
     }
 
     // Victory animation: rainbow chase + winner's side flashing
-    // Returns true when animation is complete (after ~8 seconds)
-    bool animateVictory(const PingPongGame& game) {
-        unsigned long elapsed = millis() - game.animStartTime;
+    // (fx::VICTORY_RAINBOW, fx::VICTORY_FLASH).
+    // Returns true when animation is complete (after VICTORY_ANIM_MS)
+    bool animateVictory(const GameCore& game) {
+        PROFILE_SCOPE(ANIM_VICTORY);
+        unsigned long now = millis();
+        if (now - game.animStartTime > VICTORY_ANIM_MS) return true;
+
+        beginEffects();
+        _effects.play(fx::VICTORY_RAINBOW, game.animStartTime,
+                      EffectTarget::ringWindow(_victoryRing, tables::victoryRingOffset));
+        int8_t w = game.winner();
+        if (w >= 0) {
+            uint8_t n = game.score[w];
+            if (n > tables::SCORE_POSITIONS[w]) n = tables::SCORE_POSITIONS[w];
+            _effects.play(fx::VICTORY_FLASH, game.animStartTime,
+                          EffectTarget::pixelList(tables::SCORE_PIXEL.index[w], n));
+        }
+        endEffects(now);
+        show();
+        return false;
+    }
 
-        if (elapsed > 8000) return true;  // 8 seconds then stop
+    // Startup animation: quick rainbow test, then fade out.
+    // Time-based and non-blocking: call startStartup() once, then
+    // animateStartup() every frame until it returns true (or cancelStartup()).
+    void startStartup() {
+        stopEffects();
+        _startupStart = millis();
+        _startupActive = true;
+        clearAll();
+    }
+
+    bool startupActive() const { return _startupActive; }
 
-        int frame = elapsed / ANIMATION_SPEED_MS;
+    // Returns true when the animation is complete
+    bool animateStartup() {
+        PROFILE_SCOPE(ANIM_STARTUP);
+        if (!_startupActive) return true;
 
-        // Rainbow sweep across entire strip
-        for (int i = 0; i < TOTAL_LEDS; i++) {
-            leds[i] = CHSV((i * 7) + (frame * 8), 255, 200);
+        unsigned long elapsed = millis() - _startupStart;
+        const unsigned long wipeMs = (unsigned long)TOTAL_LEDS * STARTUP_WIPE_MS;
+        const unsigned long fadeStart = wipeMs + STARTUP_HOLD_MS;
+        const unsigned long fadeMs = (180 / 5 + 1) * STARTUP_FADE_MS;
+
+        if (elapsed >= fadeStart + fadeMs) {
+            cancelStartup();
+            return true;
         }
 
-        // Flash the winner's score brighter
-        int8_t w = game.winner();
-        if (w >= 0 && (frame / 5) % 2 == 0) {
-            for (int i = 0; i < game.score[w] && i * 2 < SCORE_LEDS_PER_SIDE; i++) {
-                int idx = (w == 0) ? (P1_LED_OFFSET + i * 2) : (TOTAL_LEDS - 1 - (i * 2));
-                leds[idx] = VICTORY_FLASH_COLOR;
-            }
+        // Fade out in steps of 5 every STARTUP_FADE_MS. Done in the pixels,
+        // not FastLED.setBrightness(), which would fade every table's strip.
+        int val = 180;
+        if (elapsed >= fadeStart) {
+            val -= (int)((elapsed - fadeStart) / STARTUP_FADE_MS) * 5;
+            if (val < 0) val = 0;
+        }
+
+        // Wipe: one more LED every STARTUP_WIPE_MS
+        int lit = (elapsed >= wipeMs) ? TOTAL_LEDS : (int)(elapsed / STARTUP_WIPE_MS) + 1;
+        for (int i = 0; i < lit; i++) {
+            leds[i] = CHSV(i * (256 / TOTAL_LEDS), 255, val);
         }
+        markAllDirty();
 
-        FastLED.show();
+        show();
         return false;
     }
 
-    // Startup animation: quick rainbow test
-    void animateStartup() {
-        for (int i = 0; i < TOTAL_LEDS; i++) {
-            leds[i] = CHSV(i * (256 / TOTAL_LEDS), 255, 180);
-            FastLED.show();
-            delay(10);
-        }
-        delay(500);
-
-        // Fade out
-        for (int b = 180; b >= 0; b -= 5) {
-            FastLED.setBrightness(b);
-            FastLED.show();
-            delay(15);
-        }
-        FastLED.setBrightness(BRIGHTNESS);
+    // Stop the startup animation (e.g. a button was pressed) and blank the strip
+    void cancelStartup() {
+        _startupActive = false;
         clearAll();
-        FastLED.show();
+        show();
     }
 
-    // Normal frame: render score + serve indicator
-    void renderPlaying(const PingPongGame& game) {
-        clearAll();
-        renderScore(game);
+    // Normal frame: render score + serve indicator.
+    // The score layer is patched from queued ops, or redrawn if that fails.
+    void renderPlaying(const GameCore& game) {
+        PROFILE_SCOPE(RENDER_PLAYING);
+        stopEffects();
+        if (!updateScoreLayer(Layer::PLAYING, game)) {
+            clearAll();
+            renderScore(game);
+            setLayer(Layer::PLAYING, game);
+        }
         renderServeIndicator(game);
-        FastLED.show();
+        show();
     }
 
-    // Post-victory: show final score with loser's side dimmed
-    void renderGameOver(const PingPongGame& game) {
+    // Post-victory: show final score with loser's side dimmed.
+    // Static frame — only rendered once per result.
+    void renderGameOver(const GameCore& game) {
+        PROFILE_SCOPE(RENDER_GAME_OVER);
+        stopEffects();
+        if (layerCurrent(Layer::GAME_OVER, game)) return;
+
         clearAll();
         renderScore(game);
 
@@ -201,17 +417,187 @@ public:
             }
         }
 
-        FastLED.show();
+        setLayer(Layer::GAME_OVER, game);
+        show();
+    }
+
+    // OTA update in progress: the score as it stands with a steady serve
+    // indicator. Static, so once drawn show() has nothing more to send.
+    void renderFrozen(const GameCore& game) {
+        stopEffects();
+        if (_startupActive) cancelStartup();
+        if (game.state == GameState::GAME_OVER) {
+            renderGameOver(game);
+            return;
+        }
+        if (!updateScoreLayer(Layer::PLAYING, game)) {
+            clearAll();
+            renderScore(game);
+            setLayer(Layer::PLAYING, game);
+        }
+        if (game.servingPlayer != _servePlayer) moveServe(game.servingPlayer);
+        if (game.servingPlayer <= 1) {
+            leds[tables::SERVE_PIXEL[game.servingPlayer]] = SERVE_COLOR;
+            markDirty(tables::SERVE_PIXEL[game.servingPlayer]);
+        }
+        show();
     }
 
     // "Ready to play" idle: just show serve indicator pulsing
-    void renderIdle(const PingPongGame& game) {
-        clearAll();
+    void renderIdle(const GameCore& game) {
+        PROFILE_SCOPE(RENDER_IDLE);
+        stopEffects();
+        if (!updateScoreLayer(Layer::IDLE, game)) {
+            clearAll();
+            setLayer(Layer::IDLE, game);
+        }
         renderServeIndicator(game);
-        FastLED.show();
+        show();
+    }
+
+private:
+    // Which static layer leds[] currently holds, and the score it was drawn for
+    enum class Layer : uint8_t { NONE, PLAYING, IDLE, GAME_OVER };
+
+    CRGB _shown[TOTAL_LEDS];          // Front buffer: last frame sent to the strip
+    static inline CRGB _victoryRing[tables::VICTORY_RING_LEN];  // Rainbow, shared by every display
+    static inline bool _victoryRingBuilt = false;
+    EffectEngine _effects;            // Animation layers over the score
+    uint8_t _shownBrightness = 0;
+    int32_t _shownLoad = 0;           // R+G+B over _shown (LedFrame power estimate)
+    int16_t _dirtyLo = 0;             // Dirty span [_dirtyLo, _dirtyHi)
+    int16_t _dirtyHi = TOTAL_LEDS;
+    Layer _layer = Layer::NONE;
+    uint8_t _layerScore[2] = {0, 0};
+    uint8_t _servePlayer = NO_PLAYER;  // Side the serve indicator was last drawn on
+    ScoreRenderQueue _ops;
+    unsigned long _startupStart = 0;
+    bool _startupActive = false;
+
+    // Sum of R+G+B over _shown[lo, hi)
+    int32_t channelSum(int lo, int hi) const {
+        int32_t sum = 0;
+        for (int i = lo; i < hi; i++) sum += _shown[i].r + _shown[i].g + _shown[i].b;
+        return sum;
+    }
+
+    void trackLoad(int32_t load) {
+        LedFrame::addLoad(load - _shownLoad);
+        _shownLoad = load;
+    }
+
+    // =========================================================================
+    // EFFECT LAYERS (effects.h)
+    // =========================================================================
+
+    // Before touching the score layer: take last frame's effects off it
+    void beginEffects() {
+        uint16_t lo, hi;
+        if (_effects.restore(leds, lo, hi)) markDirtySpan(lo, hi);
+    }
+
+    // After: draw this frame's effects over it
+    void endEffects(unsigned long now) {
+        uint16_t lo, hi;
+        if (_effects.paint(leds, now, lo, hi)) markDirtySpan(lo, hi);
+    }
+
+    // Leave the plain score layer (a non-animated renderer takes over)
+    void stopEffects() {
+        if (!_effects.any()) return;
+        beginEffects();
+        _effects.stopAll();
+    }
+
+    void markDirtySpan(uint16_t lo, uint16_t hi) {
+        if (lo < _dirtyLo) _dirtyLo = lo;
+        if (hi > _dirtyHi) _dirtyHi = hi;
+    }
+
+    void clearDirty() {
+        _dirtyLo = TOTAL_LEDS;
+        _dirtyHi = 0;
+    }
+
+    // Entry k holds hue k * VICTORY_HUE_PER_LED: 256 entries cover every hue,
+    // and the extra TOTAL_LEDS let any frame be one contiguous memcpy. Built
+    // by the first display's begin(), read-only after that.
+    static void buildVictoryRing() {
+        if (_victoryRingBuilt) return;
+        _victoryRingBuilt = true;
+        for (uint16_t k = 0; k < tables::VICTORY_RING_LEN; k++) {
+            _victoryRing[k] = CHSV(k * VICTORY_HUE_PER_LED, 255, VICTORY_RAINBOW_VAL);
+        }
     }
 
-    void show() {
-        FastLED.show();
+    bool layerCurrent(Layer layer, const GameCore& game) const {
+        return _layer == layer &&
+               _layerScore[0] == game.score[0] &&
+               _layerScore[1] == game.score[1];
+    }
+
+    void setLayer(Layer layer, const GameCore& game) {
+        _layer = layer;
+        _layerScore[0] = game.score[0];
+        _layerScore[1] = game.score[1];
+        _ops.clear();  // Layer now reflects every queued change
+    }
+
+    // Bring the PLAYING / IDLE score layer up to date by applying queued ops.
+    // Both layers are the same pixels at 0-0, so either can be patched into
+    // the other. Returns false if the caller must redraw from scratch.
+    bool updateScoreLayer(Layer layer, const GameCore& game) {
+        if (layerCurrent(layer, game) && _ops.empty()) return true;
+        if (_layer != Layer::PLAYING && _layer != Layer::IDLE) return false;
+        if (_ops.overflowed()) return false;
+
+        RenderOp op;
+        while (_ops.pop(op)) {
+            if (!applyOp(op)) return false;
+        }
+
+        // Ops must account for the whole score change (e.g. not a direct
+        // write to game.score); otherwise redraw
+        if (_layerScore[0] != game.score[0] || _layerScore[1] != game.score[1]) return false;
+        _layer = layer;
+        return true;
+    }
+
+    bool applyOp(const RenderOp& op) {
+        switch (op.type) {
+            case RenderOpType::SET_POINT:
+            case RenderOpType::CLEAR_POINT: {
+                if (op.player > 1) return false;
+                bool set = (op.type == RenderOpType::SET_POINT);
+                if (op.index < tables::SCORE_POSITIONS[op.player]) {
+                    uint16_t idx = tables::SCORE_PIXEL.index[op.player][op.index];
+                    leds[idx] = set ? SCORE_COLORS[tables::POINT_COLOR.group[op.index]] : BG_COLOR;
+                    markDirty(idx);
+                }
+                _layerScore[op.player] = set ? op.index + 1 : op.index;
+                return true;
+            }
+            case RenderOpType::ADVANTAGE:
+                for (uint8_t p = 0; p < 2; p++) {
+                    leds[tables::ADVANTAGE_PIXEL[p]] = (op.player == p) ? DEUCE_ADV_COLOR : BG_COLOR;
+                    markDirty(tables::ADVANTAGE_PIXEL[p]);
+                }
+                return true;
+            case RenderOpType::SERVE:
+                moveServe(op.player);
+                return true;
+            case RenderOpType::FULL_REDRAW:
+                return false;
+        }
+        return false;
+    }
+
+    // Blank the old serve indicator; renderServeIndicator() draws the new one
+    void moveServe(uint8_t player) {
+        if (_servePlayer <= 1) {
+            leds[tables::SERVE_PIXEL[_servePlayer]] = BG_COLOR;
+            markDirty(tables::SERVE_PIXEL[_servePlayer]);
+        }
+        _servePlayer = player;
     }
 };
@@ -0,0 +1,350 @@
+#pragma once
+
+#include <FastLED.h>
+#include "config.h"
+#include "tables.h"
+
+// =============================================================================
+// EFFECT ENGINE
+// =============================================================================
+// Animations are data: an EffectDef (in flash, see `fx` below) names a shape
+// and keyframe tracks for its position and opacity. Each frame the tracks
+// are sampled at the real time since the effect started, so a late frame
+// just lands further along instead of stretching the animation.
+//
+// Effects are layers over the score. ScoreDisplay keeps the score pixels in
+// leds[] as usual; before it touches that base layer, restore() puts back
+// the pixels the last frame's effects covered, and after it, paint() saves
+// the pixels this frame's effects cover and draws over them. Nothing outside
+// that span is read or written, and the base layer costs what it always did.
+//
+// Usage (per frame, inside ScoreDisplay):
+//   restore(leds, lo, hi);                         // effect pixels -> base
+//   ...patch the score layer...
+//   play(fx::SERVE_SWEEP, startMs, EffectTarget::path(a, b));
+//   paint(leds, millis(), lo, hi);                 // base -> effect pixels
+//   show();
+
+enum class EffectShape : uint8_t {
+    COMET,          // Head moving from target.from to target.to, fading trail behind
+    RING_WINDOW,    // Every pixel from target.ring, window shifted by the position track
+    PIXELS          // target.pixels[0 .. count) in one color
+};
+
+enum class EffectBlend : uint8_t {
+    MIX,            // Cross-fade toward the effect color by opacity (255 = replace)
+    ADD             // Add the effect color, scaled by opacity, saturating
+};
+
+// Track value at a time; a repeated time makes a step
+struct EffectKey {
+    uint16_t atMs;
+    uint16_t value;
+};
+
+struct EffectTrack {
+    const EffectKey *keys;
+    uint8_t count;          // 0 = constant (position 0, opacity 255)
+};
+
+struct EffectDef {
+    EffectShape shape;
+    EffectBlend blend;
+    uint16_t durationMs;    // Visible from 0 to durationMs after the start
+    uint16_t loopMs;        // Tracks repeat with this period (0 = once)
+    EffectTrack position;   // COMET: 0..65535 along the path; RING_WINDOW: hue << 8
+    EffectTrack opacity;    // 0..255
+    uint32_t color;         // COMET / PIXELS
+    uint8_t trail;          // COMET: lit pixels, head included
+    uint8_t falloff;        // COMET: opacity lost per trail pixel
+};
+
+// What a running effect is drawn on
+struct EffectTarget {
+    uint16_t from = 0;                      // COMET path
+    uint16_t to = 0;
+    const uint16_t *pixels = nullptr;       // PIXELS
+    uint8_t count = 0;
+    const CRGB *ring = nullptr;             // RING_WINDOW: >= 256 + TOTAL_LEDS entries
+    uint8_t (*ringOffset)(uint8_t hue) = nullptr;
+
+    static EffectTarget path(uint16_t from, uint16_t to) {
+        EffectTarget t;
+        t.from = from;
+        t.to = to;
+        return t;
+    }
+
+    static EffectTarget pixelList(const uint16_t *pixels, uint8_t count) {
+        EffectTarget t;
+        t.pixels = pixels;
+        t.count = count;
+        return t;
+    }
+
+    static EffectTarget ringWindow(const CRGB *ring, uint8_t (*offset)(uint8_t hue)) {
+        EffectTarget t;
+        t.ring = ring;
+        t.ringOffset = offset;
+        return t;
+    }
+};
+
+// =============================================================================
+// EFFECT TABLES
+// =============================================================================
+
+namespace fx {
+
+// Serve change: a white comet from the old server's serve LED to the new
+// one's, arriving one animation step before the end
+inline constexpr EffectKey SWEEP_POSITION[] = {
+    {0, 0}, {SERVE_SWEEP_MS - ANIMATION_SPEED_MS, 65535}
+};
+
+inline constexpr EffectDef SERVE_SWEEP = {
+    EffectShape::COMET, EffectBlend::MIX, SERVE_SWEEP_MS, 0,
+    {SWEEP_POSITION, 2}, {nullptr, 0}, SERVE_ANIM_COLOR, 10, 25
+};
+
+// Victory: the rainbow turns VICTORY_HUE_PER_FRAME every animation step...
+inline constexpr uint16_t VICTORY_HUE_TURN_MS = 256 * ANIMATION_SPEED_MS / VICTORY_HUE_PER_FRAME;
+
+inline constexpr EffectKey RAINBOW_POSITION[] = {
+    {0, 0}, {VICTORY_HUE_TURN_MS, 65535}
+};
+
+inline constexpr EffectDef VICTORY_RAINBOW = {
+    EffectShape::RING_WINDOW, EffectBlend::MIX, VICTORY_ANIM_MS, VICTORY_HUE_TURN_MS,
+    {RAINBOW_POSITION, 2}, {nullptr, 0}, 0, 0, 0
+};
+
+// ...while the winner's points blink over it, 5 steps on, 5 off
+inline constexpr EffectKey FLASH_OPACITY[] = {
+    {0, 255}, {5 * ANIMATION_SPEED_MS, 255}, {5 * ANIMATION_SPEED_MS, 0}, {10 * ANIMATION_SPEED_MS, 0}
+};
+
+inline constexpr EffectDef VICTORY_FLASH = {
+    EffectShape::PIXELS, EffectBlend::MIX, VICTORY_ANIM_MS, 10 * ANIMATION_SPEED_MS,
+    {nullptr, 0}, {FLASH_OPACITY, 4}, VICTORY_FLASH_COLOR, 0, 0
+};
+
+}  // namespace fx
+
+// =============================================================================
+// EffectEngine — up to EFFECT_SLOTS effects, drawn in start order
+// =============================================================================
+
+class EffectEngine {
+public:
+    // Keep `def` running from `startMs`: starts it, or restarts it if it is
+    // running from another start. Cheap to call every frame.
+    void play(const EffectDef& def, unsigned long startMs, const EffectTarget& target) {
+        Slot *free = nullptr;
+        for (Slot& s : _slots) {
+            if (s.def == &def) {
+                if (s.startMs != startMs) start(s, def, startMs, target);
+                return;
+            }
+            if (!s.def && !free) free = &s;
+        }
+        if (free) start(*free, def, startMs, target);
+    }
+
+    bool any() const {
+        for (const Slot& s : _slots) {
+            if (s.def) return true;
+        }
+        return false;
+    }
+
+    void stopAll() {
+        for (Slot& s : _slots) s.def = nullptr;
+    }
+
+    // Put back the base pixels under the last paint(). False if there were
+    // none; otherwise [lo, hi) was rewritten.
+    bool restore(CRGB *leds, uint16_t& lo, uint16_t& hi) {
+        if (_savedLo >= _savedHi) return false;
+        lo = _savedLo;
+        hi = _savedHi;
+        memcpy(&leds[lo], &_under[lo], (hi - lo) * sizeof(CRGB));
+        forget();
+        return true;
+    }
+
+    // leds[] was redrawn from scratch: drop the effects and the (stale)
+    // base pixels saved under them
+    void reset() {
+        stopAll();
+        forget();
+    }
+
+    // Save what this frame's effects cover and draw them. Effects past their
+    // duration stop. False if nothing was drawn; otherwise [lo, hi) changed.
+    bool paint(CRGB *leds, unsigned long now, uint16_t& lo, uint16_t& hi) {
+        lo = TOTAL_LEDS;
+        hi = 0;
+        for (Slot& s : _slots) {
+            if (!s.def) continue;
+            uint32_t elapsed = now - s.startMs;
+            if (elapsed > s.def->durationMs) {
+                s.def = nullptr;
+                continue;
+            }
+            evaluate(s, elapsed);
+            if (s.lo < lo) lo = s.lo;
+            if (s.hi > hi) hi = s.hi;
+        }
+        if (lo >= hi) return false;
+
+        memcpy(&_under[lo], &leds[lo], (hi - lo) * sizeof(CRGB));
+        _savedLo = lo;
+        _savedHi = hi;
+        for (Slot& s : _slots) {
+            if (s.def && s.opacity) draw(s, leds);
+        }
+        return true;
+    }
+
+    // Sample a track at `t` ms (linear between keys, held past the ends)
+    static uint16_t sample(const EffectTrack& track, uint32_t t, uint16_t constant) {
+        if (track.count == 0) return constant;
+        const EffectKey *k = track.keys;
+        if (t <= k[0].atMs) return k[0].value;
+        for (uint8_t i = 0; i + 1 < track.count; i++) {
+            if (t >= k[i + 1].atMs) continue;
+            int32_t span = k[i + 1].atMs - k[i].atMs;
+            int32_t delta = (int32_t)k[i + 1].value - k[i].value;
+            return (uint16_t)(k[i].value + delta * (int32_t)(t - k[i].atMs) / span);
+        }
+        return k[track.count - 1].value;
+    }
+
+private:
+    struct Slot {
+        const EffectDef *def = nullptr;
+        unsigned long startMs = 0;
+        EffectTarget target;
+        // This frame, from evaluate()
+        uint16_t position = 0;
+        uint8_t opacity = 0;
+        uint16_t lo = 0, hi = 0;
+    };
+
+    Slot _slots[EFFECT_SLOTS];
+    CRGB _under[TOTAL_LEDS];        // Base pixels in [_savedLo, _savedHi)
+    uint16_t _savedLo = 0;
+    uint16_t _savedHi = 0;
+
+    void forget() {
+        _savedLo = 0;
+        _savedHi = 0;
+    }
+
+    static void start(Slot& s, const EffectDef& def, unsigned long startMs, const EffectTarget& target) {
+        s.def = &def;
+        s.startMs = startMs;
+        s.target = target;
+    }
+
+    // Track values and covered span at `elapsed` ms
+    static void evaluate(Slot& s, uint32_t elapsed) {
+        const EffectDef& d = *s.def;
+        uint32_t t = d.loopMs ? elapsed % d.loopMs : elapsed;
+        s.position = sample(d.position, t, 0);
+        s.opacity = (uint8_t)sample(d.opacity, t, 255);
+
+        switch (d.shape) {
+            case EffectShape::COMET: {
+                int head = cometHead(s);
+                int tail = head + tailDir(s) * (d.trail - 1);
+                s.lo = clampPixel(head < tail ? head : tail);
+                s.hi = clampPixel((head < tail ? tail : head) + 1);
+                break;
+            }
+            case EffectShape::RING_WINDOW:
+                s.lo = 0;
+                s.hi = TOTAL_LEDS;
+                break;
+            case EffectShape::PIXELS:
+                s.lo = TOTAL_LEDS;
+                s.hi = 0;
+                for (uint8_t i = 0; i < s.target.count; i++) {
+                    uint16_t p = s.target.pixels[i];
+                    if (p < s.lo) s.lo = p;
+                    if (p + 1 > s.hi) s.hi = p + 1;
+                }
+                break;
+        }
+    }
+
+    static void draw(const Slot& s, CRGB *leds) {
+        const EffectDef& d = *s.def;
+        CRGB color(d.color);
+        switch (d.shape) {
+            case EffectShape::COMET: {
+                int head = cometHead(s);
+                int dir = tailDir(s);
+                for (int i = 0; i < d.trail; i++) {
+                    int idx = head + i * dir;
+                    if (idx < 0 || idx >= TOTAL_LEDS) continue;
+                    int fade = 255 - i * d.falloff;
+                    if (fade <= 0) break;
+                    uint8_t amount = (s.opacity == 255) ? fade : scale8(fade, s.opacity);
+                    blend(leds[idx], color, amount, d.blend);
+                }
+                break;
+            }
+            case EffectShape::RING_WINDOW: {
+                const CRGB *window = &s.target.ring[s.target.ringOffset((s.position + 128) >> 8)];
+                if (s.opacity == 255 && d.blend == EffectBlend::MIX) {
+                    memcpy(leds, window, TOTAL_LEDS * sizeof(CRGB));
+                } else {
+                    for (int i = 0; i < TOTAL_LEDS; i++) blend(leds[i], window[i], s.opacity, d.blend);
+                }
+                break;
+            }
+            case EffectShape::PIXELS:
+                for (uint8_t i = 0; i < s.target.count; i++) {
+                    blend(leds[s.target.pixels[i]], color, s.opacity, d.blend);
+                }
+                break;
+        }
+    }
+
+    // Head pixel for position 0..65535 along from -> to
+    static int cometHead(const Slot& s) {
+        int32_t from = s.target.from;
+        int32_t to = s.target.to;
+        return from + (to - from) * s.position / 65535;
+    }
+
+    // The trail points back toward where the comet came from
+    static int tailDir(const Slot& s) {
+        return (s.target.from < s.target.to) ? -1 : 1;
+    }
+
+    static uint16_t clampPixel(int idx) {
+        if (idx < 0) return 0;
+        if (idx > TOTAL_LEDS) return TOTAL_LEDS;
+        return idx;
+    }
+
+    static void blend(CRGB& px, const CRGB& color, uint8_t amount, EffectBlend mode) {
+        if (mode == EffectBlend::ADD) {
+            for (uint8_t c = 0; c < 3; c++) {
+                uint16_t sum = px.raw[c] + scale8(color.raw[c], amount);
+                px.raw[c] = (sum > 255) ? 255 : sum;
+            }
+            return;
+        }
+        if (amount == 255) {
+            px = color;
+        } else if (amount) {
+            for (uint8_t c = 0; c < 3; c++) {
+                px.raw[c] = scale8(px.raw[c], 255 - amount) + scale8(color.raw[c], amount);
+            }
+        }
+    }
+};
@@ -2,6 +2,10 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "rules.h"
+#include "tables.h"
+#include "renderops.h"
+#include "matchstats.h"
 
 // =============================================================================
 // GAME STATE
@@ -13,14 +17,88 @@ enum class GameState {
     GAME_OVER         // Someone won, victory animation
 };
 
-struct PingPongGame {
+// What every rule set shares: the score and serve, plus the rule results for
+// the current score (deuce, game point, winner). BasicGame keeps those
+// current, so the display, telnet and state packets read a game without
+// knowing its rules, and the snapshot to the network core is one type.
+struct GameCore {
     uint8_t score[2];       // score[0] = Player 1, score[1] = Player 2
     uint8_t servingPlayer;  // 0 or 1
     uint8_t firstServer;    // Who served first this game (for serve tracking)
     GameState state;
     unsigned long animStartTime;
+    ScoreRenderQueue *renderOps = nullptr;  // Optional: receives a render op per change
+    RunHistory *runHistory = nullptr;       // Optional: earlier runs, for removePoint()
+
+    RuleSet rules = RuleSet::CLASSIC_21;
+    bool deuce = false;
+    bool gamePoint = false;
+    int8_t winnerPlayer = -1;
+    GameStats stats;        // Serve holds, runs, deuces this game (matchstats.h)
+
+    // Total points played in the game
+    uint16_t totalPoints() const {
+        return (uint16_t)score[0] + (uint16_t)score[1];
+    }
+
+    // Are we in deuce territory?
+    bool isDeuce() const { return deuce; }
+
+    // Is one player at game point (match point) without deuce?
+    bool isGamePoint() const { return gamePoint; }
+
+    // Has someone won?
+    bool isGameWon() const { return winnerPlayer >= 0; }
+
+    // Return the winner (0 or 1), or -1 if no winner
+    int8_t winner() const { return winnerPlayer; }
+
+    // Player whose advantage LED is lit (deuce with a lead), else NO_PLAYER
+    uint8_t advantagePlayer() const {
+        if (!deuce || score[0] == score[1]) return NO_PLAYER;
+        return (score[0] > score[1]) ? 0 : 1;
+    }
+
+    // Ask the display to redraw the score from scratch (state was rebuilt)
+    void requestFullRedraw() {
+        emit(RenderOpType::FULL_REDRAW);
+    }
+
+protected:
+    void emit(RenderOpType type, uint8_t player = NO_PLAYER, uint8_t index = 0) {
+        if (renderOps) renderOps->push(type, player, index);
+    }
+};
+
+// The rules for one rule set (rules.h). Adds no data, only code.
+template <class Rules>
+struct BasicGame : GameCore {
+    typedef Rules RuleType;
+
+    // Rule checks for any score, folded to constants per rule set
+    static bool deuceAt(uint8_t p1, uint8_t p2) {
+        return p1 >= Rules::deuceThreshold && p2 >= Rules::deuceThreshold;
+    }
+
+    static int8_t winnerAt(uint8_t p1, uint8_t p2) {
+        for (int p = 0; p < 2; p++) {
+            uint8_t mine = p ? p2 : p1;
+            uint8_t theirs = p ? p1 : p2;
+            if (mine >= Rules::pointsToWin) {
+                // If both reached deuce threshold, must win by winBy
+                if (!deuceAt(p1, p2) || (int)mine - (int)theirs >= Rules::winBy) return p;
+            }
+        }
+        return -1;
+    }
+
+    // Who serves at (p1, p2) (precomputed table, see tables.h)
+    static uint8_t serverAt(uint8_t p1, uint8_t p2, uint8_t firstServer) {
+        return tables::servingPlayer<Rules>(p1, p2, firstServer);
+    }
 
     void reset() {
+        rules = Rules::id;
         score[0] = 0;
         score[1] = 0;
         // Default to P1; overridden after game over
@@ -28,51 +106,31 @@ struct PingPongGame {
         servingPlayer = firstServer;
         state = GameState::PLAYING;
         animStartTime = 0;
+        stats.clear();
+        if (runHistory) runHistory->clear();
+        refresh();
+        emit(RenderOpType::FULL_REDRAW);
     }
 
-    // Total points played in the game
-    uint16_t totalPoints() const {
-        return (uint16_t)score[0] + (uint16_t)score[1];
-    }
-
-    // Are we in deuce territory?
-    bool isDeuce() const {
-        return score[0] >= DEUCE_THRESHOLD && score[1] >= DEUCE_THRESHOLD;
+    // Jump to a score with the serve recomputed (restore, tests). The
+    // caller redraws.
+    void setScore(uint8_t p1, uint8_t p2) {
+        score[0] = p1;
+        score[1] = p2;
+        servingPlayer = calculateServingPlayer();
+        refresh();
     }
 
-    // Is one player at game point (match point) without deuce?
-    bool isGamePoint() const {
-        return !isDeuce() &&
-               (score[0] >= POINTS_TO_WIN - 1 || score[1] >= POINTS_TO_WIN - 1);
+    // Hand the first serve to the other player (only meaningful at 0-0)
+    void swapFirstServer() {
+        firstServer = 1 - firstServer;
+        servingPlayer = calculateServingPlayer();
+        emit(RenderOpType::SERVE, servingPlayer);
     }
 
-    // Calculate who should be serving based on total points
+    // Calculate who should be serving based on the score
     uint8_t calculateServingPlayer() const {
-        uint16_t total = totalPoints();
-
-        if (!isDeuce()) {
-            // Game point: trailing player serves until they tie or lose
-            if (isGamePoint()) {
-                return (score[0] >= POINTS_TO_WIN - 1) ? 1 : 0;
-            }
-
-            // Normal play: switch every SERVE_SWITCH_EVERY points
-            uint8_t serveBlock = total / SERVE_SWITCH_EVERY;
-            return (firstServer + serveBlock) % 2;
-        } else {
-            // Deuce: player without advantage serves
-            // When tied, use alternating every DEUCE_SERVE_SWITCH points
-            if (score[0] > score[1]) return 1;  // P2 serves (P1 has advantage)
-            if (score[1] > score[0]) return 0;  // P1 serves (P2 has advantage)
-
-            // Tied in deuce: alternate every DEUCE_SERVE_SWITCH points
-            uint16_t pointsBeforeDeuce = DEUCE_THRESHOLD * 2;
-            uint16_t blocksBeforeDeuce = pointsBeforeDeuce / SERVE_SWITCH_EVERY;
-            uint16_t deucePoints = total - pointsBeforeDeuce;
-            uint16_t deuceBlocks = deucePoints / DEUCE_SERVE_SWITCH;
-
-            return (firstServer + blocksBeforeDeuce + deuceBlocks) % 2;
-        }
+        return serverAt(score[0], score[1], firstServer);
     }
 
     // Add a point. Returns true if serve changes.
@@ -80,10 +138,14 @@ struct PingPongGame {
         if (state != GameState::PLAYING) return false;
         if (player > 1) return false;
 
+        uint8_t adv = advantagePlayer();
         score[player]++;
+        refresh();
+        stats.pointWon(player, servingPlayer, deuce && score[0] == score[1], runHistory);
         uint8_t newServer = calculateServingPlayer();
         bool serveChanged = (newServer != servingPlayer);
         servingPlayer = newServer;
+        emitChange(RenderOpType::SET_POINT, player, adv, serveChanged);
 
         // Check for win
         if (isGameWon()) {
@@ -103,32 +165,40 @@ struct PingPongGame {
     // Remove a point from a player (for undo via double-tap)
     void removePoint(uint8_t player) {
         if (player > 1 || score[player] == 0) return;
+        uint8_t adv = advantagePlayer();
+        uint8_t oldServer = servingPlayer;
+        bool wasDeuceTie = deuce && score[0] == score[1];
         score[player]--;
+        refresh();
         servingPlayer = calculateServingPlayer();
+        stats.pointRemoved(player, servingPlayer, wasDeuceTie, runHistory);
+        emitChange(RenderOpType::CLEAR_POINT, player, adv, servingPlayer != oldServer);
         // If game was over, go back to playing
         if (state == GameState::GAME_OVER) {
             state = GameState::PLAYING;
         }
     }
 
-    // Check if someone has won
-    bool isGameWon() const {
-        for (int p = 0; p < 2; p++) {
-            if (score[p] >= POINTS_TO_WIN) {
-                // If both reached deuce threshold, must win by WIN_BY
-                if (score[0] >= DEUCE_THRESHOLD && score[1] >= DEUCE_THRESHOLD) {
-                    if ((int)score[p] - (int)score[1 - p] >= WIN_BY) return true;
-                } else {
-                    return true;
-                }
-            }
-        }
-        return false;
+private:
+    // Recompute the cached rule results after the score changed
+    void refresh() {
+        deuce = deuceAt(score[0], score[1]);
+        gamePoint = !deuce && (score[0] >= Rules::pointsToWin - 1 ||
+                               score[1] >= Rules::pointsToWin - 1);
+        winnerPlayer = winnerAt(score[0], score[1]);
     }
 
-    // Return the winner (0 or 1), or -1 if no winner
-    int8_t winner() const {
-        if (!isGameWon()) return -1;
-        return (score[0] > score[1]) ? 0 : 1;
+    // Ops for one point added / removed: the point pixel, then the
+    // advantage LED and serve indicator if they moved
+    void emitChange(RenderOpType pointOp, uint8_t player, uint8_t oldAdv, bool serveChanged) {
+        if (!renderOps) return;
+        uint8_t index = (pointOp == RenderOpType::SET_POINT) ? score[player] - 1 : score[player];
+        emit(pointOp, player, index);
+        uint8_t adv = advantagePlayer();
+        if (adv != oldAdv) emit(RenderOpType::ADVANTAGE, adv);
+        if (serveChanged) emit(RenderOpType::SERVE, servingPlayer);
     }
 };
+
+typedef BasicGame<Classic21> PingPongGame;  // The default rule set
+typedef BasicGame<Ittf11> IttfGame;
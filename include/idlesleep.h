@@ -0,0 +1,120 @@
+#pragma once
+
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include "config.h"
+#include "buttons.h"
+
+// =============================================================================
+// IdleSleep — light sleep between games
+// =============================================================================
+// After IDLE_SLEEP_MS of quiet idle frames the game core blanks the strips
+// and puts the chip into light sleep, woken by any score button (GPIO level
+// wake) or a timer every IDLE_SLEEP_SLICE_MS. On a timer wake the chip stays
+// up for IDLE_SLEEP_AWAKE_MS so the network task can serve WiFi beacons,
+// telnet and OTA, then sleeps again; WiFi runs in modem sleep, so the
+// association survives the slices.
+//
+// While asleep the buttons' edge interrupts are paused (a level wake source
+// would otherwise re-fire continuously), so the press that woke the chip is
+// never seen as an edge. It is queued by hand on wake, timestamped at the
+// wake, so that press still scores.
+//
+// Usage:
+//   IdleSleep idleSleep;
+//   idleSleep.activity();                  // any frame that isn't quiet idle
+//   if (idleSleep.due()) idleSleep.sleep(buttons, n, stopFn);
+
+class IdleSleep {
+public:
+    void activity(unsigned long now = millis()) { _lastActive = now; }
+
+    bool due(unsigned long now = millis()) const {
+        return IDLE_SLEEP_MS > 0 && now - _lastActive >= IDLE_SLEEP_MS;
+    }
+
+    // Sleep until a button is pressed (true) or `stop()` asks to wake
+    // (false), checked after every slice.
+    template <typename StopFn>
+    bool sleep(ButtonState *const *buttons, uint8_t count, StopFn stop) {
+        _sleeps++;
+        for (;;) {
+            for (uint8_t i = 0; i < count; i++) armWake(*buttons[i]);
+            esp_sleep_enable_gpio_wakeup();
+            esp_sleep_enable_timer_wakeup((uint64_t)IDLE_SLEEP_SLICE_MS * 1000);
+
+            bool slept = esp_light_sleep_start() == ESP_OK;
+            uint32_t wakeUs = micros();
+            bool pressed = slept && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+            for (uint8_t i = 0; i < count; i++) restoreAfterWake(*buttons[i], wakeUs);
+            esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+
+            if (pressed) {
+                _wakeUs = esp_timer_get_time();
+                _pending = true;
+                activity();
+                return true;
+            }
+            if (slept) {
+                _slices++;
+                vTaskDelay(pdMS_TO_TICKS(IDLE_SLEEP_AWAKE_MS));
+            } else {
+                _rejected++;    // WiFi not in modem sleep, or a wake source already active
+                vTaskDelay(pdMS_TO_TICKS(IDLE_SLEEP_SLICE_MS));
+            }
+            if (stop()) {
+                activity();
+                return false;
+            }
+        }
+    }
+
+    // After the first frame following a button wake: microseconds since
+    // the wake, once (0 otherwise)
+    uint32_t takeWakeLatencyUs() {
+        if (!_pending) return 0;
+        _pending = false;
+        _lastLatencyUs = (uint32_t)(esp_timer_get_time() - _wakeUs);
+        if (_lastLatencyUs > _maxLatencyUs) _maxLatencyUs = _lastLatencyUs;
+        return _lastLatencyUs;
+    }
+
+    uint32_t sleeps() const { return _sleeps; }
+    uint32_t slices() const { return _slices; }
+    uint32_t rejected() const { return _rejected; }
+    uint32_t lastLatencyUs() const { return _lastLatencyUs; }
+    uint32_t maxLatencyUs() const { return _maxLatencyUs; }
+
+private:
+    unsigned long _lastActive = 0;
+    int64_t _wakeUs = 0;
+    bool _pending = false;
+    uint32_t _sleeps = 0;
+    uint32_t _slices = 0;
+    uint32_t _rejected = 0;
+    uint32_t _lastLatencyUs = 0;
+    uint32_t _maxLatencyUs = 0;
+
+    static void armWake(ButtonState& b) {
+        gpio_num_t pin = (gpio_num_t)b.pin;
+#if BUTTON_USE_INTERRUPTS
+        gpio_intr_disable(pin);
+#endif
+        gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+    }
+
+    static void restoreAfterWake(ButtonState& b, [[maybe_unused]] uint32_t wakeUs) {
+        gpio_num_t pin = (gpio_num_t)b.pin;
+        gpio_wakeup_disable(pin);
+#if BUTTON_USE_INTERRUPTS
+        // Held now: the press happened while edges weren't captured. Pushed
+        // before the interrupt is back on, so the ISR stays the queue's only
+        // producer; a release in between is caught by update()'s settled
+        // level check.
+        if (digitalRead(b.pin) == LOW) b.edges.push({wakeUs, LOW});
+        gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+        gpio_intr_enable(pin);
+#endif
+    }
+};
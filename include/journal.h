@@ -0,0 +1,238 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "game.h"
+
+// =============================================================================
+// POINT JOURNAL
+// =============================================================================
+// Fixed-capacity log of everything that changed the score, two bytes per
+// event, static RAM only. The game state is always a pure function of the
+// journal: undo removes an event and replay() rebuilds the game from scratch,
+// so the serve order after an undo is exactly what it would have been had
+// the point never been played (including first-server swaps).
+//
+// Record layout (uint16_t):
+//   bits 15..13  JournalEvent
+//   bits 12..0   time since the previous event, JOURNAL_TICK_MS units
+//                (saturates at ~13.6 min)
+//
+// When full, the oldest record is folded into a base score so recording
+// never fails; only events older than the window stop being undoable one by
+// one (their points can still be taken back from the base).
+//
+// The journal also holds the rule set the game is played under; replay()
+// must be given the matching BasicGame variant.
+
+// Linear copy of a journal (oldest record first), for persistence
+struct JournalImage {
+    uint8_t baseScore[2];
+    uint8_t baseFirstServer;
+    uint8_t rules;              // RuleSet (0 = classic, so older images read as before)
+    uint16_t count;
+    uint16_t records[JOURNAL_CAPACITY];
+};
+
+enum class JournalEvent : uint8_t {
+    POINT_P1,       // Player 1 scored
+    POINT_P2,       // Player 2 scored
+    SWAP_SERVER,    // First server swapped (0-0 double-tap, or `server` command)
+    RESET           // Game reset mid-match; everything before is discarded
+};
+
+class PointJournal {
+public:
+    static const uint16_t MAX_DELTA = (1 << 13) - 1;
+
+    // Start a fresh game with `firstServer` serving
+    void startGame(uint8_t firstServer, unsigned long now = millis()) {
+        _count = 0;
+        _first = 0;
+        _baseScore[0] = 0;
+        _baseScore[1] = 0;
+        _baseFirstServer = firstServer;
+        _lastEventMs = now;
+        _revision++;
+    }
+
+    // Start a fresh game under other rules
+    void startRules(RuleSet rules, uint8_t firstServer, unsigned long now = millis()) {
+        _rules = rules;
+        startGame(firstServer, now);
+    }
+
+    // Start over from a given score (a correction); the events that led to
+    // it are not known, so undo stops there
+    void startFrom(uint8_t p1, uint8_t p2, uint8_t firstServer, unsigned long now = millis()) {
+        startGame(firstServer, now);
+        _baseScore[0] = p1;
+        _baseScore[1] = p2;
+    }
+
+    void recordPoint(uint8_t player, unsigned long now = millis()) {
+        record(player == 0 ? JournalEvent::POINT_P1 : JournalEvent::POINT_P2, now);
+    }
+
+    void recordSwap(unsigned long now = millis()) { record(JournalEvent::SWAP_SERVER, now); }
+    void recordReset(unsigned long now = millis()) { record(JournalEvent::RESET, now); }
+
+    // Remove the most recent event of any kind. False if there is nothing
+    // left to undo in the window.
+    bool undo() {
+        if (_count == 0) return false;
+        _count--;
+        _revision++;
+        return true;
+    }
+
+    // Remove `player`'s most recent point in the current game (it need not be
+    // the last event). False if they have no points.
+    bool undoPoint(uint8_t player) {
+        JournalEvent point = (player == 0) ? JournalEvent::POINT_P1 : JournalEvent::POINT_P2;
+        for (uint16_t i = _count; i-- > 0;) {
+            JournalEvent e = type(at(i));
+            if (e == JournalEvent::RESET) return false;
+            if (e == point) {
+                erase(i);
+                _revision++;
+                return true;
+            }
+        }
+        if (_baseScore[player] == 0) return false;
+        _baseScore[player]--;
+        _revision++;
+        return true;
+    }
+
+    // Rebuild `game` from the journal. Render ops are replaced by a single
+    // full redraw; the game is left PLAYING, like removePoint().
+    template <class Game>
+    void replay(Game& game) const {
+        ScoreRenderQueue *ops = game.renderOps;
+        game.renderOps = nullptr;
+
+        // Only events after the last reset matter
+        uint16_t start = _count;
+        while (start > 0 && type(at(start - 1)) != JournalEvent::RESET) start--;
+
+        game.reset();
+        if (start == 0) {
+            game.firstServer = _baseFirstServer;
+            game.setScore(_baseScore[0], _baseScore[1]);
+        }
+
+        for (uint16_t i = start; i < _count; i++) {
+            switch (type(at(i))) {
+                case JournalEvent::POINT_P1:
+                case JournalEvent::POINT_P2:
+                    game.state = GameState::PLAYING;
+                    game.addPoint(type(at(i)) == JournalEvent::POINT_P1 ? 0 : 1);
+                    break;
+                case JournalEvent::SWAP_SERVER:
+                    game.swapFirstServer();
+                    break;
+                case JournalEvent::RESET:
+                    break;
+            }
+        }
+        game.state = GameState::PLAYING;
+        game.animStartTime = 0;
+
+        game.renderOps = ops;
+        game.requestFullRedraw();
+    }
+
+    RuleSet rules() const { return _rules; }
+
+    // Records currently held (oldest first), for stats / persistence
+    uint16_t size() const { return _count; }
+    uint16_t raw(uint16_t i) const { return at(i); }
+
+    // Changes on every edit (to spot when a save is due)
+    uint32_t revision() const { return _revision; }
+
+    void save(JournalImage& img) const {
+        img.baseScore[0] = _baseScore[0];
+        img.baseScore[1] = _baseScore[1];
+        img.baseFirstServer = _baseFirstServer;
+        img.rules = (uint8_t)_rules;
+        img.count = _count;
+        for (uint16_t i = 0; i < JOURNAL_CAPACITY; i++) img.records[i] = (i < _count) ? at(i) : 0;
+    }
+
+    // Timestamps continue from `now`. False (journal untouched) if the image
+    // is out of range.
+    bool load(const JournalImage& img, unsigned long now = millis()) {
+        if (img.count > JOURNAL_CAPACITY || img.baseFirstServer > 1 ||
+            img.rules >= RULE_SET_COUNT) return false;
+        _baseScore[0] = img.baseScore[0];
+        _baseScore[1] = img.baseScore[1];
+        _baseFirstServer = img.baseFirstServer;
+        _rules = (RuleSet)img.rules;
+        _first = 0;
+        _count = img.count;
+        memcpy(_records, img.records, sizeof(_records));
+        _lastEventMs = now;
+        _revision++;
+        return true;
+    }
+
+    static JournalEvent type(uint16_t rec) { return (JournalEvent)(rec >> 13); }
+    static uint16_t deltaTicks(uint16_t rec) { return rec & MAX_DELTA; }
+
+private:
+    uint16_t _records[JOURNAL_CAPACITY];
+    uint16_t _first = 0;            // Oldest record (ring start)
+    uint16_t _count = 0;
+    uint8_t _baseScore[2] = {0, 0};  // Score before the oldest record
+    uint8_t _baseFirstServer = 0;
+    RuleSet _rules = RuleSet::CLASSIC_21;
+    unsigned long _lastEventMs = 0;
+    uint32_t _revision = 0;
+
+    uint16_t at(uint16_t i) const { return _records[(_first + i) % JOURNAL_CAPACITY]; }
+
+    void record(JournalEvent e, unsigned long now) {
+        unsigned long ticks = (now - _lastEventMs) / JOURNAL_TICK_MS;
+        _lastEventMs = now;
+        if (ticks > MAX_DELTA) ticks = MAX_DELTA;
+
+        if (_count == JOURNAL_CAPACITY) foldOldest();
+        _records[(_first + _count) % JOURNAL_CAPACITY] = ((uint16_t)e << 13) | (uint16_t)ticks;
+        _count++;
+        _revision++;
+    }
+
+    // Apply the oldest record to the base and drop it
+    void foldOldest() {
+        switch (type(at(0))) {
+            case JournalEvent::POINT_P1:    _baseScore[0]++; break;
+            case JournalEvent::POINT_P2:    _baseScore[1]++; break;
+            case JournalEvent::SWAP_SERVER: _baseFirstServer ^= 1; break;
+            case JournalEvent::RESET:
+                _baseScore[0] = 0;
+                _baseScore[1] = 0;
+                _baseFirstServer = 0;   // BasicGame::reset() default
+                break;
+        }
+        _first = (_first + 1) % JOURNAL_CAPACITY;
+        _count--;
+    }
+
+    // Remove record i, keeping the rest in order. Its time delta is merged
+    // into the next record so later timestamps don't shift.
+    void erase(uint16_t i) {
+        uint16_t carry = deltaTicks(at(i));
+        for (uint16_t j = i; j + 1 < _count; j++) {
+            _records[(_first + j) % JOURNAL_CAPACITY] = at(j + 1);
+        }
+        _count--;
+        if (i < _count) {
+            uint16_t& next = _records[(_first + i) % JOURNAL_CAPACITY];
+            uint16_t merged = deltaTicks(next) + carry;
+            if (merged > MAX_DELTA) merged = MAX_DELTA;
+            next = (next & ~MAX_DELTA) | merged;
+        }
+    }
+};
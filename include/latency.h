@@ -0,0 +1,254 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// EDGE-TO-PHOTON LATENCY BENCHMARK
+// =============================================================================
+// Build with -D PINGPONG_LATENCY_BENCH (env:esp32-latency) to follow every
+// scored point through three timestamps:
+//   edge   - micros() of the button edge, taken in the ISR (ButtonState::tapUs)
+//   commit - addPoint() has applied it to the game
+//   photon - the first FastLED.show() carrying it has returned
+// into histograms of edge->commit, commit->photon and edge->photon. Type
+// `latency` in a telnet session for p50/p95/p99/max (`latency reset` clears).
+//
+// Self-test: wire a spare GPIO (LATENCY_INJECT_PIN) to the P1 button pin.
+// The network task then presses it every LATENCY_INJECT_PERIOD_MS, so the
+// numbers are taken under live WiFi / telnet load.
+//
+// A speculative point (SPECULATIVE_TAPS) is held back from the histograms
+// until its tap resolves: kept if it was a single press, dropped if it was
+// taken back, so only points that count are measured.
+//
+// Without the flag, the LATENCY_*() macros expand to nothing.
+//
+// Usage:
+//   game.addPoint(0);
+//   LATENCY_COMMIT(btn1.tapUs);    // after the point is in the game
+//   LATENCY_SPECULATE(edgeUs);     // ...or a point that may be taken back,
+//   LATENCY_CONFIRM(edgeUs);       //    then either it counts
+//   LATENCY_DISCARD(edgeUs);       //    or it doesn't
+//   LATENCY_FRAME_SENT();          // a frame starts going out (LedFrame)
+//   LATENCY_FRAME_DONE();          // ...and is on the strip (after show())
+
+#ifdef PINGPONG_LATENCY_BENCH
+
+#include <atomic>
+
+class LatencyBench {
+public:
+    enum Stage : uint8_t { EDGE_TO_COMMIT, COMMIT_TO_PHOTON, EDGE_TO_PHOTON, STAGE_COUNT };
+
+    // Bucket layout: 100 us steps below 10 ms, 1 ms below 100 ms, 10 ms
+    // below 1 s, then one open-ended bucket
+    static const uint16_t NUM_BUCKETS = 100 + 90 + 90 + 1;
+
+    // Game core: a point from the edge at `edgeUs` is now in the game
+    // (`held`: not recorded until confirm())
+    void commit(uint32_t edgeUs, bool held = false) {
+        if (_pendingCount == LATENCY_PENDING) {
+            _dropped++;
+            return;
+        }
+        _pending[_pendingCount++] = {edgeUs, (uint32_t)micros(), 0, 0, false, held};
+    }
+
+    // Game core: the held point from `edgeUs` counts (recorded at the next
+    // poll, once its frame is out) or was taken back
+    void confirm(uint32_t edgeUs) {
+        for (uint8_t i = 0; i < _pendingCount; i++) {
+            if (_pending[i].held && _pending[i].edgeUs == edgeUs) _pending[i].held = false;
+        }
+    }
+
+    void discard(uint32_t edgeUs) {
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < _pendingCount; i++) {
+            if (!(_pending[i].held && _pending[i].edgeUs == edgeUs)) _pending[kept++] = _pending[i];
+        }
+        _pendingCount = kept;
+    }
+
+    // Game core, as a frame is handed to the LEDs: it carries every point
+    // committed so far
+    void frameSent() {
+        poll();
+        uint32_t seq = ++_sentSeq;
+        for (uint8_t i = 0; i < _pendingCount; i++) {
+            if (_pending[i].frame == 0) _pending[i].frame = seq;
+        }
+    }
+
+    // Whichever task ran FastLED.show(), when it returns. Frames finish in
+    // the order they were sent; the last two finish times are kept so the
+    // game core can match them up a frame late.
+    void frameDone() {
+        uint32_t seq = _doneSeq.load(std::memory_order_relaxed) + 1;
+        _doneUs[seq & 1] = micros();
+        _doneSeq.store(seq, std::memory_order_release);
+    }
+
+    // Game core: record points whose frame has finished
+    void poll() {
+        uint32_t done = _doneSeq.load(std::memory_order_acquire);
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < _pendingCount; i++) {
+            Pending p = _pending[i];
+            if (!p.lit) {
+                if (p.frame == 0 || p.frame > done) {
+                    _pending[kept++] = p;
+                    continue;
+                }
+                if (done - p.frame >= 2) {
+                    _dropped++;     // Finish time already overwritten
+                    continue;
+                }
+                p.photonUs = _doneUs[p.frame & 1];
+                p.lit = true;
+            }
+            if (p.held) {
+                _pending[kept++] = p;   // Waiting for its tap to resolve
+                continue;
+            }
+            record(EDGE_TO_COMMIT, p.commitUs - p.edgeUs);
+            record(COMMIT_TO_PHOTON, p.photonUs - p.commitUs);
+            record(EDGE_TO_PHOTON, p.photonUs - p.edgeUs);
+        }
+        _pendingCount = kept;
+    }
+
+    // Network task: drive the self-test press pin
+    void inject([[maybe_unused]] unsigned long now) {
+#if LATENCY_INJECT_PIN >= 0
+        if (!_injectBegun) {
+            pinMode(LATENCY_INJECT_PIN, OUTPUT_OPEN_DRAIN);   // The button's pull-up releases it
+            digitalWrite(LATENCY_INJECT_PIN, HIGH);
+            _injectBegun = true;
+            _injectAt = now;
+        }
+        if (!_injectLow && now - _injectAt >= LATENCY_INJECT_PERIOD_MS) {
+            digitalWrite(LATENCY_INJECT_PIN, LOW);
+            _injectLow = true;
+            _injectAt = now;
+            _injected++;
+        } else if (_injectLow && now - _injectAt >= LATENCY_INJECT_HOLD_MS) {
+            digitalWrite(LATENCY_INJECT_PIN, HIGH);
+            _injectLow = false;
+        }
+#endif
+    }
+
+    // Histograms are written by the game core and read here by the network
+    // task without locking; a dump racing a record may be off by one sample.
+    void reset() {
+        memset(_hist, 0, sizeof(_hist));
+        _dropped = 0;
+    }
+
+    template <class Out>
+    void dump(Out& out) const {
+        static const char *const stageNames[STAGE_COUNT] = {
+            "edge->commit", "commit->photon", "edge->photon"
+        };
+        out.println("latency          count     p50_us     p95_us     p99_us     max_us");
+        for (uint8_t s = 0; s < STAGE_COUNT; s++) {
+            const Histogram& h = _hist[s];
+            out.printf("%-14s %7lu %10lu %10lu %10lu %10lu\r\n", stageNames[s],
+                       (unsigned long)h.count, (unsigned long)percentile(h, 50),
+                       (unsigned long)percentile(h, 95), (unsigned long)percentile(h, 99),
+                       (unsigned long)h.maxUs);
+        }
+        out.printf("Dropped %lu points, self-test presses %lu (pin %d)\r\n",
+                   (unsigned long)_dropped, (unsigned long)_injected, LATENCY_INJECT_PIN);
+    }
+
+private:
+    struct Pending {
+        uint32_t edgeUs;
+        uint32_t commitUs;
+        uint32_t frame;     // Frame that carries it (0 = not sent yet)
+        uint32_t photonUs;  // That frame's finish time, once lit
+        bool lit;
+        bool held;          // Speculative: not recorded until confirmed
+    };
+
+    struct Histogram {
+        uint32_t count;
+        uint32_t maxUs;
+        uint32_t buckets[NUM_BUCKETS];
+    };
+
+    Pending _pending[LATENCY_PENDING];
+    uint8_t _pendingCount = 0;
+    uint32_t _sentSeq = 0;
+    std::atomic<uint32_t> _doneSeq{0};
+    uint32_t _doneUs[2] = {0, 0};
+    uint32_t _dropped = 0;
+    Histogram _hist[STAGE_COUNT] = {};
+
+    bool _injectBegun = false;
+    bool _injectLow = false;
+    unsigned long _injectAt = 0;
+    uint32_t _injected = 0;
+
+    static uint16_t bucketOf(uint32_t us) {
+        if (us < 10000) return us / 100;
+        if (us < 100000) return 100 + (us - 10000) / 1000;
+        if (us < 1000000) return 190 + (us - 100000) / 10000;
+        return NUM_BUCKETS - 1;
+    }
+
+    static uint32_t bucketTopUs(uint16_t b) {
+        if (b < 100) return (b + 1) * 100;
+        if (b < 190) return 10000 + (b - 99) * 1000;
+        return 100000 + (b - 189) * 10000;
+    }
+
+    void record(Stage stage, uint32_t us) {
+        Histogram& h = _hist[stage];
+        h.buckets[bucketOf(us)]++;
+        h.count++;
+        if (us > h.maxUs) h.maxUs = us;
+    }
+
+    // Upper edge of the bucket holding the pct-th percentile (never above max)
+    static uint32_t percentile(const Histogram& h, uint8_t pct) {
+        if (h.count == 0) return 0;
+        uint32_t rank = (uint32_t)(((uint64_t)h.count * pct + 99) / 100);
+        uint32_t seen = 0;
+        for (uint16_t b = 0; b < NUM_BUCKETS - 1; b++) {
+            seen += h.buckets[b];
+            if (seen >= rank) return bucketTopUs(b) < h.maxUs ? bucketTopUs(b) : h.maxUs;
+        }
+        return h.maxUs;
+    }
+};
+
+inline LatencyBench& latencyBench() {
+    static LatencyBench bench;
+    return bench;
+}
+
+#define LATENCY_COMMIT(edgeUs) latencyBench().commit(edgeUs)
+#define LATENCY_SPECULATE(edgeUs) latencyBench().commit(edgeUs, true)
+#define LATENCY_CONFIRM(edgeUs) latencyBench().confirm(edgeUs)
+#define LATENCY_DISCARD(edgeUs) latencyBench().discard(edgeUs)
+#define LATENCY_FRAME_SENT()   latencyBench().frameSent()
+#define LATENCY_FRAME_DONE()   latencyBench().frameDone()
+#define LATENCY_POLL()         latencyBench().poll()
+#define LATENCY_INJECT(now)    latencyBench().inject(now)
+
+#else
+
+#define LATENCY_COMMIT(edgeUs) do {} while (0)
+#define LATENCY_SPECULATE(edgeUs) do {} while (0)
+#define LATENCY_CONFIRM(edgeUs) do {} while (0)
+#define LATENCY_DISCARD(edgeUs) do {} while (0)
+#define LATENCY_FRAME_SENT()   do {} while (0)
+#define LATENCY_FRAME_DONE()   do {} while (0)
+#define LATENCY_POLL()         do {} while (0)
+#define LATENCY_INJECT(now)    do {} while (0)
+
+#endif
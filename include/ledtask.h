@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <atomic>
+#include "config.h"
+#include "display.h"
+#include "profiler.h"
+#include "latency.h"
+
+// =============================================================================
+// LedOutputTask — clocks LED frames out in the background
+// =============================================================================
+// FastLED.show() returns only once every strip has been sent (~4.3 ms for 144
+// WS2815 pixels), sleeping on the RMT driver's completion semaphore. Calling
+// it from a task of its own on the game core turns that wait into free CPU
+// time for loop(): LedFrame hands the frame over with a notification and the
+// game goes on reading buttons and rendering into the back buffers. Before a
+// display next writes its front buffer it waits for the transmission to end
+// (in practice it ended long ago: frames are >= 33 ms apart).
+//
+// Usage:
+//   LedOutputTask::begin();    // setup(), after the displays' begin()
+
+class LedOutputTask {
+public:
+    static void begin() {
+        _done = xSemaphoreCreateBinary();
+        xTaskCreatePinnedToCore(run, "led", LED_TASK_STACK, nullptr,
+                                LED_TASK_PRIORITY, &_task, LED_TASK_CORE);
+        LedFrame::setOutput(transmit, waitIdle);
+    }
+
+    // Longest time loop() had to wait for a transmission to finish
+    static uint32_t maxWaitUs() { return _maxWaitUs; }
+    static uint32_t frames() { return _frames; }
+    static TaskHandle_t task() { return _task; }
+
+private:
+    static inline TaskHandle_t _task = nullptr;
+    static inline SemaphoreHandle_t _done = nullptr;
+    static inline std::atomic<bool> _busy{false};
+    static inline uint8_t _scale = 0;
+    static inline uint32_t _maxWaitUs = 0;
+    static inline uint32_t _frames = 0;
+
+    // Game core: start a frame (LedFrame::send())
+    static void transmit(uint8_t scale) {
+        waitIdle();
+        xSemaphoreTake(_done, 0);   // Drop a completion nobody waited for
+        _scale = scale;
+        _busy = true;
+        xTaskNotifyGive(_task);
+    }
+
+    // Game core: block until the frame in flight is out
+    static void waitIdle() {
+        if (!_busy) return;
+        int64_t start = esp_timer_get_time();
+        while (_busy) xSemaphoreTake(_done, portMAX_DELAY);
+        uint32_t waited = (uint32_t)(esp_timer_get_time() - start);
+        if (waited > _maxWaitUs) _maxWaitUs = waited;
+    }
+
+    static void run(void *) {
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            {
+                PROFILE_SCOPE(LED_TRANSMIT);
+                FastLED.show(_scale);
+            }
+            LATENCY_FRAME_DONE();
+            _frames++;
+            _busy = false;
+            xSemaphoreGive(_done);
+        }
+    }
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "renderops.h"
+
+// =============================================================================
+// MATCH STATISTICS
+// =============================================================================
+// GameStats lives in GameCore and is updated in O(1) by addPoint() and
+// removePoint(), so it reaches the network core with the snapshot. Undo
+// needs nothing extra: the journal replays the game from reset(), which
+// rebuilds the counters along with the score. removePoint() on its own
+// reverses the latest point exactly within the current run (the run keeps
+// where the longest run stood when it began). Going back past the start of
+// a run needs the runs before it: a RunHistory, kept beside the journal
+// and attached with GameCore::runHistory, holds them. Without one the
+// earlier run is forgotten.
+//
+// MatchStats adds each game up when it is final: when the next game starts,
+// since until then an undo can still take the winning point back. Its
+// length comes from a GameClock, and only games played here from 0-0 have
+// one.
+
+// Finished runs of the current game, newest last, as {run, runFloor}. As
+// deep as the journal: points older than that can't be undone one by one.
+class RunHistory {
+public:
+    void clear() {
+        _kept = 0;
+        _next = 0;
+    }
+
+    void push(uint8_t run, uint8_t runFloor) {
+        _runs[_next][0] = run;
+        _runs[_next][1] = runFloor;
+        _next = (_next + 1) % JOURNAL_CAPACITY;
+        if (_kept < JOURNAL_CAPACITY) _kept++;
+    }
+
+    // The latest finished run, removed. False if none is kept.
+    bool pop(uint8_t& run, uint8_t& runFloor) {
+        if (_kept == 0) return false;
+        _kept--;
+        _next = (_next + JOURNAL_CAPACITY - 1) % JOURNAL_CAPACITY;
+        run = _runs[_next][0];
+        runFloor = _runs[_next][1];
+        return true;
+    }
+
+private:
+    uint8_t _runs[JOURNAL_CAPACITY][2];
+    uint16_t _next = 0;
+    uint16_t _kept = 0;
+};
+
+struct GameStats {
+    uint8_t served[2];      // Points played with player p serving
+    uint8_t held[2];        // ...of which the server won
+    uint8_t longest[2];     // Longest run of points in a row
+    uint8_t deuces;         // Times the score was tied at deuce or beyond
+    uint8_t run;            // Current run of points...
+    uint8_t runPlayer;      // ...won by this player (NO_PLAYER = none)
+    uint8_t runFloor;       // longest[runPlayer] when the run began
+
+    void clear() {
+        memset(this, 0, sizeof(*this));
+        runPlayer = NO_PLAYER;
+    }
+
+    // `player` won a point `server` served; `deuceTie` = the score it made.
+    // A run it ends goes to `runs` if there is one.
+    void pointWon(uint8_t player, uint8_t server, bool deuceTie, RunHistory *runs = nullptr) {
+        served[server]++;
+        if (server == player) held[server]++;
+        if (runPlayer != player) {
+            if (runs && runPlayer != NO_PLAYER) runs->push(run, runFloor);
+            runPlayer = player;
+            run = 0;
+            runFloor = longest[player];
+        }
+        run++;
+        if (run > longest[player]) longest[player] = run;
+        if (deuceTie) deuces++;
+    }
+
+    // Take back pointWon() with the same arguments. Runs alternate players,
+    // so the one before an emptied run belongs to the other player.
+    void pointRemoved(uint8_t player, uint8_t server, bool deuceTie, RunHistory *runs = nullptr) {
+        if (served[server]) served[server]--;
+        if (server == player && held[server]) held[server]--;
+        if (runPlayer == player && run > 0) {
+            run--;
+            longest[player] = (run > runFloor) ? run : runFloor;
+            if (run == 0) {
+                if (runs && runs->pop(run, runFloor)) runPlayer = 1 - player;
+                else runPlayer = NO_PLAYER;
+            }
+        }
+        if (deuceTie && deuces) deuces--;
+    }
+};
+
+// Percentage of `part` in `whole` (0 when there is none)
+inline uint8_t percentOf(uint32_t part, uint32_t whole) {
+    return whole ? (uint8_t)(part * 100 / whole) : 0;
+}
+
+// How long the current game took: from its start at 0-0 to the moment
+// its winning point was scored, both seen here. A game restored at boot or
+// jumped to with a score began before the clock did, so it has no known
+// length. The win is stamped when scored, not read off the victory
+// animation, which a rebuild backdates; a win taken back and scored again
+// is stamped again.
+struct GameClock {
+    unsigned long startedAt = 0;
+    unsigned long wonAt = 0;
+    bool timed = false;
+
+    void start(unsigned long now) {
+        startedAt = now;
+        wonAt = 0;
+        timed = true;
+    }
+
+    // Restored or set: the start was never seen
+    void forget() { timed = false; }
+
+    void won(unsigned long now) { wonAt = now; }
+
+    // 0 if unknown
+    uint32_t durationMs() const {
+        return (timed && wonAt) ? (uint32_t)(wonAt - startedAt) : 0;
+    }
+};
+
+struct MatchStats {
+    uint16_t games;
+    uint16_t wins[2];
+    uint32_t served[2];     // Finished games only
+    uint32_t held[2];
+    uint8_t longest[2];     // Longest run in any finished game
+    uint16_t deuces;
+    uint16_t timedGames;    // Finished games of known length...
+    uint32_t totalMs;       // ...and their summed length
+
+    void clear() { memset(this, 0, sizeof(*this)); }
+
+    // `durationMs` 0 = length unknown (GameClock::durationMs())
+    void gameFinished(const GameStats& g, uint8_t winner, uint32_t durationMs) {
+        games++;
+        wins[winner]++;
+        for (uint8_t p = 0; p < 2; p++) {
+            served[p] += g.served[p];
+            held[p] += g.held[p];
+            if (g.longest[p] > longest[p]) longest[p] = g.longest[p];
+        }
+        deuces += g.deuces;
+        if (durationMs) {
+            timedGames++;
+            totalMs += durationMs;
+        }
+    }
+
+    uint32_t averageMs() const { return timedGames ? totalMs / timedGames : 0; }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "statepacket.h"
+
+// =============================================================================
+// MemoryMonitor — heap and task stack telemetry
+// =============================================================================
+// Samples free heap, the largest free block (the gap between the two is
+// fragmentation), the lowest free heap since boot and each watched task's
+// stack high-water mark. The network task samples every MEM_REPORT_MS, logs
+// a line and multicasts a MetricsPacket; `stats` shows the latest sample.
+//
+// Nothing should allocate in steady state: the telnet, web and UDP buffers
+// are members of globals, and log lines and command replies are formatted
+// on the stack (printfTo(), through the printf() of DualPrint, LogLine and
+// TelnetClient; never Print::printf(), which mallocs long lines). "drift"
+// is the change in free heap since the previous sample; a board whose
+// drift stays negative report after report is leaking.
+//
+// Usage:
+//   MemoryMonitor memory;
+//   memory.watch("net", networkTaskHandle);   // setup()
+//   if (memory.due(now)) memory.sample(now);  // network task
+
+class MemoryMonitor {
+public:
+    // Track `task`'s stack (in watch order, up to MEM_MAX_TASKS)
+    void watch(const char *name, TaskHandle_t task) {
+        if (_taskCount == MEM_MAX_TASKS || !task) return;
+        _names[_taskCount] = name;
+        _tasks[_taskCount] = task;
+        _taskCount++;
+    }
+
+    bool due(unsigned long now) const { return !_sampled || now - _sampledAt >= MEM_REPORT_MS; }
+
+    void sample(unsigned long now = millis()) {
+        uint32_t prevFree = _freeHeap;
+        _freeHeap = ESP.getFreeHeap();
+        _minFreeHeap = ESP.getMinFreeHeap();
+        _largestBlock = ESP.getMaxAllocHeap();
+        for (uint8_t i = 0; i < _taskCount; i++) {
+            _stackFree[i] = uxTaskGetStackHighWaterMark(_tasks[i]);   // Bytes on ESP32
+        }
+        _drift = _sampled ? (int32_t)(_freeHeap - prevFree) : 0;
+        _sampled = true;
+        _sampledAt = now;
+    }
+
+    // Percent of free heap not in the largest block
+    uint8_t fragmentation() const {
+        return _freeHeap ? (uint8_t)(100 - (uint64_t)_largestBlock * 100 / _freeHeap) : 0;
+    }
+
+    template <class Out>
+    void print(Out& out) const {
+        out.printf("Heap: %lu free, %lu largest block (%u%% fragmented), %lu min, drift %ld\r\n",
+                   (unsigned long)_freeHeap, (unsigned long)_largestBlock, fragmentation(),
+                   (unsigned long)_minFreeHeap, (long)_drift);
+        out.print("Stack free:");
+        for (uint8_t i = 0; i < _taskCount; i++) {
+            out.printf(" %s %lu", _names[i], (unsigned long)_stackFree[i]);
+        }
+        out.println();
+    }
+
+    // seq is set by the sender
+    void fill(MetricsPacket& p) const {
+        memset(&p, 0, sizeof(p));
+        p.magic = METRICS_PACKET_MAGIC;
+        p.version = METRICS_PACKET_VERSION;
+        p.tasks = _taskCount;
+        p.uptimeS = _sampledAt / 1000;
+        p.freeHeap = _freeHeap;
+        p.minFreeHeap = _minFreeHeap;
+        p.largestBlock = _largestBlock;
+        for (uint8_t i = 0; i < _taskCount; i++) {
+            p.stackFree[i] = _stackFree[i] < 0xFFFF ? _stackFree[i] : 0xFFFF;
+        }
+    }
+
+    bool sampled() const { return _sampled; }
+
+private:
+    const char *_names[MEM_MAX_TASKS];
+    TaskHandle_t _tasks[MEM_MAX_TASKS];
+    uint32_t _stackFree[MEM_MAX_TASKS] = {};
+    uint8_t _taskCount = 0;
+    bool _sampled = false;
+    unsigned long _sampledAt = 0;
+    uint32_t _freeHeap = 0;
+    uint32_t _minFreeHeap = 0;
+    uint32_t _largestBlock = 0;
+    int32_t _drift = 0;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "game.h"
+
+// =============================================================================
+// MIRROR PACKET
+// =============================================================================
+// A change to one table's game, broadcast to mirror displays (mirrorlink.h).
+// Fixed 16 bytes, little-endian, no padding:
+//
+//   off size field
+//    0   2   magic   0x524D ("MR")
+//    2   1   version MIRROR_PACKET_VERSION
+//    3   1   kind    MirrorKind
+//    4   4   seq     +1 per packet for this table
+//    8   1   table   0-based table on the primary
+//    9   1   player  who scored / lost the point (POINT, UNPOINT)
+//   10   2   score   P1, P2 after the change
+//   12   1   firstServer
+//   13   1   rules   RuleSet
+//   14   2   reserved 0
+//
+// Every packet carries the whole score, so the delta is only a hint: a
+// mirror that follows seq applies it with addPoint() / removePoint() and
+// plays the same animations as the primary; after a gap it jumps to the
+// score carried. KEYFRAMEs repeat the state every MIRROR_KEYFRAME_MS, in
+// case the last change itself was lost.
+
+#define MIRROR_PACKET_MAGIC     0x524D
+#define MIRROR_PACKET_VERSION   1
+
+enum class MirrorKind : uint8_t {
+    KEYFRAME,   // State as it stands (first packet, heartbeat, anything else)
+    POINT,      // `player` scored
+    UNPOINT     // `player`'s latest point was taken back
+};
+
+struct __attribute__((packed)) MirrorPacket {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t kind;
+    uint32_t seq;
+    uint8_t table;
+    uint8_t player;
+    uint8_t score[2];
+    uint8_t firstServer;
+    uint8_t rules;
+    uint8_t reserved[2];
+
+    bool valid() const {
+        return magic == MIRROR_PACKET_MAGIC && version == MIRROR_PACKET_VERSION &&
+               kind <= (uint8_t)MirrorKind::UNPOINT && player <= 1 && firstServer <= 1 &&
+               rules < RULE_SET_COUNT;
+    }
+
+    // Same game as `game` (what a mirror shows)
+    bool matches(const GameCore& game) const {
+        return score[0] == game.score[0] && score[1] == game.score[1] &&
+               firstServer == game.firstServer && rules == (uint8_t)game.rules;
+    }
+};
+
+static_assert(sizeof(MirrorPacket) == 16, "MirrorPacket layout changed");
+
+// =============================================================================
+// MirrorEncoder — primary side, one per table
+// =============================================================================
+// Fed every snapshot the network task reads; says when a packet is due and
+// what kind. Only the score, first server and rules are mirrored: serve,
+// deuce and the game state follow from them on the mirror.
+
+class MirrorEncoder {
+public:
+    // True if `p` should be sent for `view`
+    bool update(const GameCore& view, uint8_t tableId, unsigned long now, MirrorPacket& p) {
+        MirrorKind kind = MirrorKind::KEYFRAME;
+        uint8_t player = 0;
+        if (_sentAny && _last.matches(view)) {
+            if (now - _lastSentAt < MIRROR_KEYFRAME_MS) return false;
+        } else if (_sentAny && _last.firstServer == view.firstServer &&
+                   _last.rules == (uint8_t)view.rules) {
+            for (uint8_t i = 0; i < 2; i++) {
+                uint8_t other = 1 - i;
+                if (view.score[other] != _last.score[other]) continue;
+                if (view.score[i] == _last.score[i] + 1) {
+                    kind = MirrorKind::POINT;
+                    player = i;
+                } else if (view.score[i] + 1 == _last.score[i]) {
+                    kind = MirrorKind::UNPOINT;
+                    player = i;
+                }
+            }
+        }
+
+        memset(&p, 0, sizeof(p));
+        p.magic = MIRROR_PACKET_MAGIC;
+        p.version = MIRROR_PACKET_VERSION;
+        p.kind = (uint8_t)kind;
+        p.seq = ++_seq;
+        p.table = tableId;
+        p.player = player;
+        p.score[0] = view.score[0];
+        p.score[1] = view.score[1];
+        p.firstServer = view.firstServer;
+        p.rules = (uint8_t)view.rules;
+
+        _last = p;
+        _sentAny = true;
+        _lastSentAt = now;
+        return true;
+    }
+
+private:
+    MirrorPacket _last;
+    bool _sentAny = false;
+    unsigned long _lastSentAt = 0;
+    uint32_t _seq = 0;
+};
+
+// =============================================================================
+// MirrorFollower — mirror side
+// =============================================================================
+// Applies packets for one table to a local game. The caller picks the
+// BasicGame variant for packet.rules first (a rules change then arrives as a
+// mismatch and resyncs).
+
+enum class MirrorApply : uint8_t {
+    IGNORED,    // Stale, duplicate, other table, or nothing new
+    DELTA,      // Played on the local game (animations as on the primary)
+    RESYNC      // Jumped to the score carried
+};
+
+class MirrorFollower {
+public:
+    explicit MirrorFollower(uint8_t tableId = 0) : _table(tableId) {}
+
+    template <class Game>
+    MirrorApply apply(const MirrorPacket& p, Game& game, unsigned long now = millis()) {
+        if (!p.valid() || p.table != _table) return MirrorApply::IGNORED;
+        bool inOrder = _synced && p.seq == _seq + 1;
+        // Behind us: a late duplicate, unless it's a keyframe (primary restarted)
+        if (_synced && (int32_t)(p.seq - _seq) <= 0 && p.kind != (uint8_t)MirrorKind::KEYFRAME) {
+            return MirrorApply::IGNORED;
+        }
+        _seq = p.seq;
+        _synced = true;
+        _lastAt = now;
+
+        if (inOrder && p.kind != (uint8_t)MirrorKind::KEYFRAME && (uint8_t)game.rules == p.rules) {
+            if (p.kind == (uint8_t)MirrorKind::POINT) {
+                if (game.state == GameState::SERVE_CHANGE) game.state = GameState::PLAYING;
+                game.addPoint(p.player);
+            } else {
+                game.removePoint(p.player);
+            }
+            if (p.matches(game)) {
+                _deltas++;
+                return MirrorApply::DELTA;
+            }
+        }
+
+        if (p.matches(game)) return MirrorApply::IGNORED;
+        resync(p, game);
+        _resyncs++;
+        return MirrorApply::RESYNC;
+    }
+
+    // Nothing valid heard for this long (0 = never heard)
+    unsigned long silentMs(unsigned long now = millis()) const {
+        return _synced ? now - _lastAt : 0;
+    }
+
+    bool synced() const { return _synced; }
+    uint32_t deltas() const { return _deltas; }
+    uint32_t resyncs() const { return _resyncs; }
+
+private:
+    uint8_t _table;
+    bool _synced = false;
+    uint32_t _seq = 0;
+    unsigned long _lastAt = 0;
+    uint32_t _deltas = 0;
+    uint32_t _resyncs = 0;
+
+    // Like a journal rebuild: a finished game goes straight to its final score
+    template <class Game>
+    static void resync(const MirrorPacket& p, Game& game) {
+        ScoreRenderQueue *ops = game.renderOps;
+        game.renderOps = nullptr;
+        game.reset();
+        game.firstServer = p.firstServer;
+        game.setScore(p.score[0], p.score[1]);
+        if (game.isGameWon()) {
+            game.state = GameState::GAME_OVER;
+            game.animStartTime = millis() - VICTORY_ANIM_MS - 1;
+        }
+        game.renderOps = ops;
+        game.requestFullRedraw();
+    }
+};
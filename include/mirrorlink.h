@@ -0,0 +1,126 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include "config.h"
+#include "mirror.h"
+#include "spsc.h"
+
+// =============================================================================
+// MIRROR LINK — MirrorPackets over ESP-NOW broadcast
+// =============================================================================
+// ESP-NOW frames go straight from radio to radio: no access point, no
+// connection, about a millisecond in the air. The primary broadcasts one
+// frame per change (plus keyframes), so its cost is the same for one mirror
+// or twenty. Both sides must be on the same WiFi channel: the primary uses
+// whatever its access point dictates (or MIRROR_CHANNEL when standalone),
+// and mirrors scan for it unless MIRROR_CHANNEL fixes one.
+//
+// Usage (primary):
+//   MirrorSender mirrors;
+//   mirrors.begin();                     // setup(), after WiFi.mode(WIFI_STA)
+//   mirrors.update(view, tableId);       // network task, every pass per table
+//
+// Usage (mirror build, src/mirror.cpp):
+//   MirrorReceiver radio;
+//   radio.begin(scheduler.task());       // wakes the frame loop per packet
+//   while (radio.pop(p)) follower.apply(p, game);
+//   radio.service(follower.synced(), follower.silentMs());   // channel scan
+
+static const uint8_t MIRROR_BROADCAST_ADDR[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+class MirrorSender {
+public:
+    void begin() {
+        if (esp_now_init() != ESP_OK) return;
+        esp_now_peer_info_t peer = {};
+        memcpy(peer.peer_addr, MIRROR_BROADCAST_ADDR, 6);
+        peer.channel = 0;               // Whatever channel the radio is on
+        peer.ifidx = WIFI_IF_STA;
+        peer.encrypt = false;
+        _ready = (esp_now_add_peer(&peer) == ESP_OK);
+    }
+
+    // Send if the table changed, or a keyframe is due
+    void update(const GameCore& view, uint8_t tableId = 0, unsigned long now = millis()) {
+        if (!_ready || tableId >= TABLE_COUNT) return;
+        MirrorPacket p;
+        if (!_encoder[tableId].update(view, tableId, now, p)) return;
+        if (esp_now_send(MIRROR_BROADCAST_ADDR, (const uint8_t *)&p, sizeof(p)) == ESP_OK) _sent++;
+        else _failed++;
+    }
+
+    uint32_t sent() const { return _sent; }
+    uint32_t failed() const { return _failed; }
+
+private:
+    bool _ready = false;
+    MirrorEncoder _encoder[TABLE_COUNT];
+    uint32_t _sent = 0;
+    uint32_t _failed = 0;
+};
+
+class MirrorReceiver {
+public:
+    // `wake` is notified for every packet (the frame loop's task)
+    void begin(TaskHandle_t wake) {
+        _wake = wake;
+        _instance = this;
+        _channel = (MIRROR_CHANNEL > 0) ? MIRROR_CHANNEL : 1;
+        esp_wifi_set_channel(_channel, WIFI_SECOND_CHAN_NONE);
+        if (esp_now_init() != ESP_OK) return;
+        esp_now_register_recv_cb(onReceive);
+        _dwellStart = millis();
+    }
+
+    // Frame loop: next packet received, oldest first
+    bool pop(MirrorPacket& p) {
+        if (!_queue.peek(p)) return false;
+        _queue.pop();
+        return true;
+    }
+
+    // Frame loop, with how long the table has been silent: while nothing is
+    // heard, step through channels 1-13 (unless MIRROR_CHANNEL is fixed)
+    void service(bool synced, unsigned long silentMs, unsigned long now = millis()) {
+        if (MIRROR_CHANNEL > 0) return;
+        bool lost = !synced || silentMs >= MIRROR_LOST_MS;
+        if (!lost) {
+            _dwellStart = now;
+            return;
+        }
+        if (now - _dwellStart < MIRROR_SCAN_MS) return;
+        _channel = (_channel % 13) + 1;
+        esp_wifi_set_channel(_channel, WIFI_SECOND_CHAN_NONE);
+        _dwellStart = now;
+    }
+
+    uint8_t channel() const { return _channel; }
+    uint32_t received() const { return _received; }
+    uint32_t dropped() const { return _queue.dropped(); }
+
+private:
+    static inline MirrorReceiver *_instance = nullptr;
+    TaskHandle_t _wake = nullptr;
+    SpscQueue<MirrorPacket, MIRROR_QUEUE_SIZE> _queue;   // WiFi task -> frame loop
+    uint8_t _channel = 1;
+    unsigned long _dwellStart = 0;
+    uint32_t _received = 0;
+
+    // WiFi task
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    static void onReceive(const esp_now_recv_info_t *, const uint8_t *data, int len) {
+#else
+    static void onReceive(const uint8_t *, const uint8_t *data, int len) {
+#endif
+        MirrorReceiver *self = _instance;
+        if (!self || len != sizeof(MirrorPacket)) return;
+        MirrorPacket p;
+        memcpy(&p, data, sizeof(p));
+        if (!p.valid()) return;
+        self->_received++;
+        if (self->_queue.push(p) && self->_wake) xTaskNotifyGive(self->_wake);
+    }
+};
@@ -2,63 +2,367 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include <lwip/sockets.h>
 #include "config.h"
 
+// Print::printf() heap-allocates lines over 63 bytes; the log and telnet
+// clients format on the stack instead (cut short at LOG_FORMAT_MAX)
+inline size_t printfTo(Print& out, const char *format, va_list args) {
+    char buf[LOG_FORMAT_MAX];
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    if (len < 0) return 0;
+    if (len >= (int)sizeof(buf)) len = sizeof(buf) - 1;
+    return out.write((const uint8_t *)buf, len);
+}
+
+// =============================================================================
+// LogLine — one log line assembled on the stack, written in one piece
+// =============================================================================
+// Both cores write to the log; a line written in parts (a table tag, then
+// the message) can be split by another task's line in between. LogLine
+// collects the parts and hands the line over in a single write() when it
+// ends with '\n' or goes out of scope. Lines over LOG_FORMAT_MAX are cut.
+//
+// Usage:
+//   LogLine(logger).printf("T%u ", 2);        // temporary: written at the ';'
+//   LogLine line(logger);                     // or named, across calls
+//   printGameState(view, line);
+
+class LogLine : public Print {
+public:
+    explicit LogLine(Print& out) : _out(out) {}
+
+    LogLine(LogLine&& other) : _out(other._out), _len(other._len) {
+        memcpy(_buf, other._buf, _len);
+        other._len = 0;
+    }
+
+    ~LogLine() { flush(); }
+
+    size_t write(uint8_t b) override {
+        return write(&b, 1);
+    }
+
+    size_t write(const uint8_t *buf, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            if (_len < sizeof(_buf)) _buf[_len++] = buf[i];
+            if (buf[i] == '\n') flush();
+        }
+        return size;
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        size_t n = printfTo(*this, format, args);
+        va_end(args);
+        return n;
+    }
+
+private:
+    Print& _out;
+    char _buf[LOG_FORMAT_MAX];
+    size_t _len = 0;
+
+    void flush() {
+        if (_len) _out.write((const uint8_t *)_buf, _len);
+        _len = 0;
+    }
+};
+
+// =============================================================================
+// TelnetClient — one telnet connection with its own output ring
+// =============================================================================
+// Everything sent to a client (log fan-out, command replies) is queued in its
+// ring and pushed out with non-blocking send(), so one slow or stuck client
+// never holds up the others or the network task. When a client's ring is
+// full its output is truncated (with a notice once it catches up); if its
+// socket accepts nothing for TELNET_STALL_MS it is disconnected.
+
+class TelnetClient : public Print {
+    static_assert((TELNET_CLIENT_BUFFER & (TELNET_CLIENT_BUFFER - 1)) == 0,
+                  "TELNET_CLIENT_BUFFER must be a power of 2");
+
+public:
+    WiFiClient sock;
+    char line[TELNET_LINE_MAX];   // Command line being typed
+    uint8_t lineLen = 0;
+    uint8_t context = 0;          // Handler state per client (selected table)
+
+    bool active() const { return _active; }
+
+    void open(const WiFiClient& s, unsigned long now) {
+        sock = s;
+        sock.setNoDelay(true);
+        _active = true;
+        _head = _tail = 0;
+        _dropped = _reportedDropped = 0;
+        _lastProgress = now;
+        lineLen = 0;
+        context = 0;
+    }
+
+    void close() {
+        sock.stop();
+        _active = false;
+    }
+
+    size_t write(uint8_t b) override {
+        return write(&b, 1);
+    }
+
+    // Queue output; whatever doesn't fit is dropped (counted)
+    size_t write(const uint8_t *buf, size_t size) override {
+        size_t room = TELNET_CLIENT_BUFFER - (_head - _tail);
+        size_t n = (size < room) ? size : room;
+        _dropped += size - n;
+        size_t at = _head & (TELNET_CLIENT_BUFFER - 1);
+        size_t first = TELNET_CLIENT_BUFFER - at;
+        if (first > n) first = n;
+        memcpy(&_buf[at], buf, first);
+        memcpy(_buf, buf + first, n - first);
+        _head += n;
+        return size;
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        size_t n = printfTo(*this, format, args);
+        va_end(args);
+        return n;
+    }
+
+    // Send what the socket will take right now. False if the connection
+    // is gone or has been stalled too long.
+    bool flush(unsigned long now) {
+        // Tell the client about truncated output once there's room again
+        uint32_t dropped = _dropped;
+        if (dropped != _reportedDropped && TELNET_CLIENT_BUFFER - (_head - _tail) >= 48) {
+            printf("\r\n[telnet: %lu bytes dropped, client too slow]\r\n",
+                   (unsigned long)(dropped - _reportedDropped));
+            _reportedDropped = dropped;
+        }
+
+        while (_head != _tail) {
+            size_t at = _tail & (TELNET_CLIENT_BUFFER - 1);
+            size_t n = _head - _tail;
+            if (n > TELNET_CLIENT_BUFFER - at) n = TELNET_CLIENT_BUFFER - at;
+            int sent = send(sock.fd(), &_buf[at], n, MSG_DONTWAIT);
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return false;
+            }
+            if (sent == 0) break;
+            _tail += sent;
+            _lastProgress = now;
+        }
+
+        if (_head == _tail) _lastProgress = now;
+        return now - _lastProgress < TELNET_STALL_MS;
+    }
+
+    uint32_t droppedBytes() const { return _dropped; }
+
+private:
+    bool _active = false;
+    uint8_t _buf[TELNET_CLIENT_BUFFER];
+    uint32_t _head = 0;
+    uint32_t _tail = 0;
+    uint32_t _dropped = 0;
+    uint32_t _reportedDropped = 0;
+    unsigned long _lastProgress = 0;   // Last time the socket took bytes (or we were idle)
+};
+
 // =============================================================================
-// DualPrint — mirrors Serial output to a telnet client over WiFi
+// DualPrint — mirrors Serial output to telnet clients over WiFi
 // =============================================================================
 // Usage:
 //   DualPrint logger;
 //   logger.begin();          // after WiFi connects
-//   logger.handle();         // in loop()
-//   logger.println("hello"); // prints to Serial AND telnet
+//   logger.handle();         // in the network task
+//   logger.println("hello"); // prints to Serial AND telnet (from any core)
+//
+// Writers only memcpy into a fixed ring buffer, so a line is formatted once
+// however many clients are listening. The network task drains it in
+// LOG_DRAIN_CHUNK pieces and copies each piece into every client's ring
+// (up to TELNET_MAX_CLIENTS). When the shared ring is full, output is dropped
+// (and counted) rather than blocking the writer.
+//
+// Lines typed by a client are passed to the onCommand() handler (see
+// commands.h); its replies are queued to that client only, not through the
+// log ring.
 
 class DualPrint : public Print {
+    static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0,
+                  "LOG_BUFFER_SIZE must be a power of 2");
+
 public:
+    // Replies go to `out`, the issuing client (its printf() formats on the
+    // stack). `context` belongs to the client and persists between its lines.
+    typedef void (*CommandHandler)(char *line, TelnetClient& out, uint8_t& context);
+
+    void onCommand(CommandHandler handler) { _onCommand = handler; }
+
     void begin() {
-        _server = new WiFiServer(TELNET_PORT);
-        _server->begin();
-        _server->setNoDelay(true);
+        _server.begin();
+        _server.setNoDelay(true);
+        _listening = true;
     }
 
     void handle() {
-        if (!_server) return;
+        unsigned long now = millis();
+        if (_listening) acceptClients(now);
+
+        // Input: one shared time slice across all clients
+        int64_t deadline = esp_timer_get_time() + TELNET_SLICE_US;
+        for (TelnetClient& c : _clients) {
+            if (c.active()) readCommands(c, deadline);
+        }
+
+        // Drain the ring in large chunks, fanning each out to every client
+        // (discarded if nobody is listening)
+        size_t budget = LOG_BUFFER_SIZE;
+        size_t n;
+        while (budget > 0 && (n = pop(_chunk, sizeof(_chunk))) > 0) {
+            for (TelnetClient& c : _clients) {
+                if (c.active()) c.write(_chunk, n);
+            }
+            budget -= (n < budget) ? n : budget;
+        }
 
-        // Accept new connections (only one client at a time)
-        if (_server->hasClient()) {
-            if (_client && _client.connected()) {
-                _client.stop();
+        uint32_t dropped = _dropped;
+        if (dropped != _reportedDropped) {
+            char note[40];
+            int len = snprintf(note, sizeof(note), "[log: %u bytes dropped]\r\n",
+                               (unsigned)(dropped - _reportedDropped));
+            for (TelnetClient& c : _clients) {
+                if (c.active()) c.write((const uint8_t *)note, len);
             }
-            _client = _server->available();
-            _client.println("=== Ping Pong Scorer telnet log ===");
+            _reportedDropped = dropped;
         }
 
-        // Drop disconnected client
-        if (_client && !_client.connected()) {
-            _client.stop();
+        // Output: non-blocking; drop clients that hung up or stalled
+        for (TelnetClient& c : _clients) {
+            if (!c.active()) continue;
+            if (!c.sock.connected() || !c.flush(now)) c.close();
         }
     }
 
     size_t write(uint8_t b) override {
-        if (_serialEnabled) Serial.write(b);
-        if (_client && _client.connected()) {
-            _client.write(b);
-        }
-        return 1;
+        return write(&b, 1);
     }
 
     size_t write(const uint8_t *buf, size_t size) override {
         if (_serialEnabled) Serial.write(buf, size);
-        if (_client && _client.connected()) {
-            _client.write(buf, size);
+
+        portENTER_CRITICAL(&_mux);
+        if (size > LOG_BUFFER_SIZE - (_head - _tail)) {
+            _dropped += size;
+        } else {
+            size_t at = _head & (LOG_BUFFER_SIZE - 1);
+            size_t first = LOG_BUFFER_SIZE - at;
+            if (first > size) first = size;
+            memcpy(&_ring[at], buf, first);
+            memcpy(_ring, buf + first, size - first);
+            _head += size;
         }
+        portEXIT_CRITICAL(&_mux);
         return size;
     }
 
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        size_t n = printfTo(*this, format, args);
+        va_end(args);
+        return n;
+    }
+
     void enableSerial(bool enabled) { _serialEnabled = enabled; }
 
+    // Total bytes discarded because the ring was full
+    uint32_t droppedBytes() const { return _dropped; }
+
+    uint8_t clientCount() const {
+        uint8_t n = 0;
+        for (const TelnetClient& c : _clients) n += c.active();
+        return n;
+    }
+
 private:
-    WiFiServer *_server = nullptr;
-    WiFiClient _client;
+    WiFiServer _server{TELNET_PORT};
+    bool _listening = false;
+    TelnetClient _clients[TELNET_MAX_CLIENTS];
     bool _serialEnabled = false;
+
+    // Ring buffer: free-running indices, shared by all writers (guarded by _mux)
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t _ring[LOG_BUFFER_SIZE];
+    uint32_t _head = 0;
+    uint32_t _tail = 0;
+    uint32_t _dropped = 0;
+
+    // Network task only
+    uint8_t _chunk[LOG_DRAIN_CHUNK];
+    uint32_t _reportedDropped = 0;
+    CommandHandler _onCommand = nullptr;
+
+    void acceptClients(unsigned long now) {
+        while (_server.hasClient()) {
+            WiFiClient s = _server.available();
+            TelnetClient *slot = nullptr;
+            for (TelnetClient& c : _clients) {
+                if (!c.active()) {
+                    slot = &c;
+                    break;
+                }
+            }
+            if (!slot) {
+                s.stop();   // Full: refuse rather than kick someone off
+                continue;
+            }
+            slot->open(s, now);
+            slot->println("=== Ping Pong Scorer telnet log ===");
+        }
+    }
+
+    // Collect a client's input into its line buffer, dispatching each
+    // complete line. Reads at most TELNET_READ_BUDGET bytes and stops at
+    // `deadline` (TELNET_SLICE_US per pass), so a chatty client can't hog the
+    // network task; the rest waits in the socket.
+    void readCommands(TelnetClient& client, int64_t deadline) {
+        for (uint16_t budget = TELNET_READ_BUDGET; budget > 0 && client.sock.available(); budget--) {
+            if (esp_timer_get_time() >= deadline) break;
+            int c = client.sock.read();
+            if (c < 0) break;
+            if (c == '\r' || c == '\n') {
+                if (client.lineLen > 0) {
+                    client.line[client.lineLen] = '\0';
+                    client.lineLen = 0;
+                    if (_onCommand) {
+                        _onCommand(client.line, client, client.context);
+                        client.flush(millis());   // Start long replies before the next fills the ring
+                    }
+                }
+            } else if (c >= ' ' && c <= '~' && client.lineLen < sizeof(client.line) - 1) {
+                client.line[client.lineLen++] = (char)c;  // Overlong lines are truncated
+            }
+        }
+    }
+
+    // Move up to `max` bytes out of the ring
+    size_t pop(uint8_t *out, size_t max) {
+        portENTER_CRITICAL(&_mux);
+        size_t n = _head - _tail;
+        if (n > max) n = max;
+        size_t at = _tail & (LOG_BUFFER_SIZE - 1);
+        size_t first = LOG_BUFFER_SIZE - at;
+        if (first > n) first = n;
+        memcpy(out, &_ring[at], first);
+        memcpy(out + first, _ring, n - first);
+        _tail += n;
+        portEXIT_CRITICAL(&_mux);
+        return n;
+    }
 };
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stddef.h>
+#include "config.h"
+#include "journal.h"
+#include "snapshot.h"
+
+// =============================================================================
+// MatchStore — survive reboots mid-game
+// =============================================================================
+// The game is a pure function of the point journal, so only the journal is
+// saved. Two copies:
+//   - RTC memory: rewritten by the game core on every change (a ~270 byte
+//     memcpy + CRC). Survives software resets: OTA reboot, panic, watchdog.
+//   - NVS flash: committed by the network task once the score has been quiet
+//     for PERSIST_QUIET_MS, so a burst of taps is one write and flash wear
+//     stays low (NVS itself wear-levels across its pages). Survives power loss.
+//
+// A flash write stalls code running from flash on both cores while it runs.
+// Committing only in a quiet spell keeps that away from scoring taps and
+// animations; the game core never waits on it.
+//
+// Usage:
+//   RTC_NOINIT_ATTR MatchImage rtcMatch;   // in main.cpp, one per table
+//   store.begin(&rtcMatch, tableId);
+//   store.restore(journal);                // setup(), before the net task
+//   store.save(journal);                   // game core, after each change
+//   store.service();                       // network task
+
+struct MatchImage {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    JournalImage journal;
+    uint16_t reserved;
+    uint32_t crc;
+};
+
+// CRC covers every byte before crc, so there must be no padding
+static_assert(offsetof(MatchImage, crc) + sizeof(uint32_t) == sizeof(MatchImage),
+              "MatchImage has padding");
+static_assert(offsetof(MatchImage, reserved) + 2 == offsetof(MatchImage, crc),
+              "MatchImage has padding");
+
+enum class RestoreSource : uint8_t { NONE, RTC, NVS };
+
+class MatchStore {
+public:
+    static const uint32_t MAGIC = 0x50505347;   // "PPSG"
+
+    // Table 0 keeps the plain key, so single-table saves carry over;
+    // further tables use "match2", "match3", ...
+    void begin(MatchImage *rtc, uint8_t tableId = 0) {
+        _rtc = rtc;
+        if (tableId == 0) snprintf(_key, sizeof(_key), "%s", PERSIST_NVS_KEY);
+        else snprintf(_key, sizeof(_key), "%s%u", PERSIST_NVS_KEY, tableId + 1);
+        _prefs.begin(PERSIST_NVS_NAMESPACE, false);
+    }
+
+    // Load the newest valid copy into `journal`: RTC first (it is never
+    // older than NVS), then NVS. The caller saves the result as usual, which
+    // brings NVS up to date if it was behind.
+    RestoreSource restore(PointJournal& journal) {
+        bool nvsValid = _prefs.getBytes(_key, &_committed, sizeof(_committed)) ==
+                            sizeof(_committed) && valid(_committed);
+        if (!nvsValid) memset(&_committed, 0, sizeof(_committed));
+
+        if (_rtc && valid(*_rtc) && journal.load(_rtc->journal)) return RestoreSource::RTC;
+        if (nvsValid && journal.load(_committed.journal)) return RestoreSource::NVS;
+        return RestoreSource::NONE;
+    }
+
+    // Game core: refresh the RTC copy and hand the image to the network task
+    void save(const PointJournal& journal) {
+        journal.save(_image.journal);
+        seal(_image);
+        if (_rtc) memcpy(_rtc, &_image, sizeof(_image));
+        _handoff.publish(_image);
+    }
+
+    // Network task: commit to NVS once changes have settled
+    void service(unsigned long now = millis()) {
+        uint32_t seq = _handoff.sequence();
+        if (seq != _seenSeq) {
+            _seenSeq = seq;
+            _changedAt = now;
+            _pending = true;
+        }
+        if (_pending && now - _changedAt >= PERSIST_QUIET_MS) commit();
+    }
+
+    // Network task: commit any pending change now (e.g. before an OTA
+    // reboot), including one published since the last service()
+    void flush() {
+        if (_handoff.sequence() != _seenSeq) {
+            _seenSeq = _handoff.sequence();
+            _pending = true;
+        }
+        if (_pending) commit();
+    }
+
+    uint32_t commits() const { return _commits; }
+    uint32_t skipped() const { return _skipped; }
+
+private:
+    MatchImage *_rtc = nullptr;
+    Preferences _prefs;
+    char _key[16];              // NVS keys are at most 15 characters
+
+    // Game core
+    MatchImage _image;
+    Snapshot<MatchImage> _handoff;
+
+    // Network task
+    MatchImage _nvsBuf;
+    MatchImage _committed;      // Last image known to be in NVS
+    uint32_t _seenSeq = 0;
+    unsigned long _changedAt = 0;
+    bool _pending = false;
+    uint32_t _commits = 0;
+    uint32_t _skipped = 0;      // Settled back to what NVS already holds
+
+    void commit() {
+        if (!_handoff.read(_nvsBuf)) return;    // Mid-publish: retry next pass
+        _pending = false;
+        if (memcmp(&_nvsBuf, &_committed, sizeof(_nvsBuf)) == 0) {
+            _skipped++;
+            return;
+        }
+        if (_prefs.putBytes(_key, &_nvsBuf, sizeof(_nvsBuf)) == sizeof(_nvsBuf)) {
+            memcpy(&_committed, &_nvsBuf, sizeof(_nvsBuf));
+            _commits++;
+        }
+    }
+
+    static void seal(MatchImage& img) {
+        img.magic = MAGIC;
+        img.version = PERSIST_VERSION;
+        img.size = sizeof(MatchImage);
+        img.reserved = 0;
+        img.crc = crc32(&img, offsetof(MatchImage, crc));
+    }
+
+    static bool valid(const MatchImage& img) {
+        return img.magic == MAGIC && img.version == PERSIST_VERSION &&
+               img.size == sizeof(MatchImage) &&
+               img.crc == crc32(&img, offsetof(MatchImage, crc));
+    }
+
+    // CRC-32 (IEEE), nibble table: small and fast enough for ~270 bytes
+    static uint32_t crc32(const void *data, size_t len) {
+        static const uint32_t table[16] = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+            0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+            0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= p[i];
+            crc = (crc >> 4) ^ table[crc & 0x0F];
+            crc = (crc >> 4) ^ table[crc & 0x0F];
+        }
+        return ~crc;
+    }
+};
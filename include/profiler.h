@@ -0,0 +1,144 @@
+#pragma once
+
+#include <Arduino.h>
+
+// =============================================================================
+// HOT-PATH PROFILER
+// =============================================================================
+// Build with -D PINGPONG_PROFILE (env:esp32-profile) to time the main loop
+// sections with the CPU cycle counter into fixed-bucket latency histograms.
+// Dump them over telnet with the `stats` command.
+//
+// Without the flag, PROFILE_SCOPE() expands to nothing and none of this is
+// compiled in.
+//
+// Usage:
+//   void renderScore(...) {
+//       PROFILE_SCOPE(RENDER_SCORE);   // times until end of the block
+//       ...
+//   }
+
+enum class ProfileSection : uint8_t {
+    BUTTON_1,
+    BUTTON_2,
+    STATE_PLAYING,
+    STATE_SERVE_CHANGE,
+    STATE_GAME_OVER,
+    RENDER_SCORE,
+    RENDER_SERVE,
+    RENDER_PLAYING,
+    RENDER_IDLE,
+    RENDER_GAME_OVER,
+    ANIM_SERVE_CHANGE,
+    ANIM_VICTORY,
+    ANIM_STARTUP,
+    LED_SHOW,
+    LED_TRANSMIT,
+    OTA_HANDLE,
+    TELNET_HANDLE,
+    WEB_HANDLE,
+    COUNT
+};
+
+#ifdef PINGPONG_PROFILE
+
+class Profiler {
+public:
+    static const uint8_t NUM_SECTIONS = (uint8_t)ProfileSection::COUNT;
+    static const uint8_t NUM_BUCKETS = 12;
+
+    // Each section is only ever recorded from one core, so no locking;
+    // a dump racing a record may be off by one sample.
+    void record(ProfileSection section, uint32_t cycles) {
+        // Upper bucket edges in microseconds (last bucket is open-ended)
+        static const uint32_t edgesUs[NUM_BUCKETS - 1] = {
+            10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000
+        };
+
+        Histogram& h = _hist[(uint8_t)section];
+        uint32_t us = cycles / cpuMHz();
+        uint8_t b = 0;
+        while (b < NUM_BUCKETS - 1 && us >= edgesUs[b]) b++;
+        h.buckets[b]++;
+        h.count++;
+        h.totalUs += us;
+        if (us > h.maxUs) h.maxUs = us;
+    }
+
+    void reset() {
+        memset(_hist, 0, sizeof(_hist));
+    }
+
+    template <class Out>
+    void dump(Out& out) const {
+        static const char *const bucketLabels[NUM_BUCKETS] = {
+            "   <10u", "   <25u", "   <50u", "  <100u", "  <250u", "  <500u",
+            "    <1m", "  <2.5m", "    <5m", "   <10m", "   <25m", "  >=25m"
+        };
+        static const char *const sectionNames[NUM_SECTIONS] = {
+            "btn1.update", "btn2.update", "handlePlaying", "handleServeChg",
+            "handleGameOver", "renderScore", "renderServe", "renderPlaying",
+            "renderIdle", "renderGameOver", "animServeChg", "animVictory",
+            "animStartup", "FastLED.show", "LED transmit", "OTA.handle", "telnet.handle",
+            "web.handle"
+        };
+
+        out.print("section          count  avg_us  max_us |");
+        for (uint8_t b = 0; b < NUM_BUCKETS; b++) out.print(bucketLabels[b]);
+        out.println();
+
+        for (uint8_t s = 0; s < NUM_SECTIONS; s++) {
+            const Histogram& h = _hist[s];
+            if (h.count == 0) continue;
+            out.printf("%-14s %7lu %7lu %7lu |", sectionNames[s], (unsigned long)h.count,
+                       (unsigned long)(h.totalUs / h.count), (unsigned long)h.maxUs);
+            for (uint8_t b = 0; b < NUM_BUCKETS; b++) {
+                out.printf(" %6lu", (unsigned long)h.buckets[b]);
+            }
+            out.println();
+        }
+    }
+
+private:
+    struct Histogram {
+        uint32_t count;
+        uint64_t totalUs;
+        uint32_t maxUs;
+        uint32_t buckets[NUM_BUCKETS];
+    };
+
+    static uint32_t cpuMHz() {
+        static uint32_t mhz = ESP.getCpuFreqMHz();
+        return mhz;
+    }
+
+    Histogram _hist[NUM_SECTIONS];
+};
+
+inline Profiler& profiler() {
+    static Profiler p;
+    return p;
+}
+
+// Times the enclosing scope (cycle counter is per core; tasks are pinned)
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileSection section)
+        : _section(section), _start(ESP.getCycleCount()) {}
+    ~ProfileScope() { profiler().record(_section, ESP.getCycleCount() - _start); }
+
+private:
+    ProfileSection _section;
+    uint32_t _start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(section) \
+    ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(ProfileSection::section)
+
+#else
+
+#define PROFILE_SCOPE(section) do {} while (0)
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include "config.h"
+
+// =============================================================================
+// RENDER OPS
+// =============================================================================
+// Game mutations describe what changed on the strip as small ops
+// (one point pixel, the advantage LED, the serve indicator) and push them
+// into a RenderQueue. ScoreDisplay applies them to its persistent frame
+// instead of redrawing the score layer. FULL_REDRAW, or a queue overflow,
+// makes the display fall back to a full redraw.
+//
+// Producer and consumer both run on the game core, so no locking.
+
+enum class RenderOpType : uint8_t {
+    SET_POINT,      // Light point (index + 1) of player
+    CLEAR_POINT,    // Blank point (index + 1) of player
+    ADVANTAGE,      // Advantage LED now on player's side (NO_PLAYER = off)
+    SERVE,          // Serve indicator moved to player
+    FULL_REDRAW     // Layer can't be patched: redraw from the game
+};
+
+#define NO_PLAYER 0xFF
+
+struct RenderOp {
+    RenderOpType type;
+    uint8_t player;
+    uint8_t index;
+};
+
+template <uint8_t N>
+class RenderQueue {
+public:
+    // Drops the op and flags an overflow when full
+    void push(RenderOpType type, uint8_t player = NO_PLAYER, uint8_t index = 0) {
+        if (_count == N) {
+            _overflowed = true;
+            return;
+        }
+        _ops[(_first + _count) % N] = {type, player, index};
+        _count++;
+    }
+
+    bool pop(RenderOp& op) {
+        if (_count == 0) return false;
+        op = _ops[_first];
+        _first = (_first + 1) % N;
+        _count--;
+        return true;
+    }
+
+    // Ops were lost since the last clear(): the queue can't be trusted
+    bool overflowed() const { return _overflowed; }
+    bool empty() const { return _count == 0; }
+
+    void clear() {
+        _first = 0;
+        _count = 0;
+        _overflowed = false;
+    }
+
+private:
+    RenderOp _ops[N];
+    uint8_t _first = 0;
+    uint8_t _count = 0;
+    bool _overflowed = false;
+};
+
+typedef RenderQueue<RENDER_QUEUE_SIZE> ScoreRenderQueue;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include "config.h"
+
+// =============================================================================
+// RULE SETS
+// =============================================================================
+// Each rule set is a type of constants. The game (BasicGame<Rules>) and its
+// serve table are instantiated once per rule set, so every rule check in a
+// variant folds to constants; the only runtime choice is which variant a
+// table runs, made once per frame.
+
+enum class RuleSet : uint8_t {
+    CLASSIC_21,
+    ITTF_11
+};
+
+constexpr uint8_t RULE_SET_COUNT = 2;
+
+struct Classic21 {
+    static constexpr RuleSet id = RuleSet::CLASSIC_21;
+    static constexpr const char *name = "21 point classic";
+    static constexpr uint8_t pointsToWin = POINTS_TO_WIN;
+    static constexpr uint8_t serveSwitchEvery = SERVE_SWITCH_EVERY;
+    static constexpr uint8_t deuceServeSwitch = DEUCE_SERVE_SWITCH;
+    static constexpr uint8_t deuceThreshold = DEUCE_THRESHOLD;
+    static constexpr uint8_t winBy = WIN_BY;
+    static constexpr bool trailingServes = TRAILING_SERVES;
+};
+
+struct Ittf11 {
+    static constexpr RuleSet id = RuleSet::ITTF_11;
+    static constexpr const char *name = "11 point ITTF";
+    static constexpr uint8_t pointsToWin = ITTF_POINTS_TO_WIN;
+    static constexpr uint8_t serveSwitchEvery = ITTF_SERVE_SWITCH_EVERY;
+    static constexpr uint8_t deuceServeSwitch = ITTF_DEUCE_SERVE_SWITCH;
+    static constexpr uint8_t deuceThreshold = ITTF_DEUCE_THRESHOLD;
+    static constexpr uint8_t winBy = ITTF_WIN_BY;
+    static constexpr bool trailingServes = ITTF_TRAILING_SERVES;
+};
+
+inline const char *ruleSetName(RuleSet r) {
+    return (r == RuleSet::ITTF_11) ? Ittf11::name : Classic21::name;
+}
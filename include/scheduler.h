@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// FrameScheduler — deadline-based frame pacing for the game loop
+// =============================================================================
+// Frames run on a fixed timestep: each deadline is the previous one plus the
+// period for the current state, so rendering cost doesn't accumulate as
+// drift. Between frames the task blocks on a FreeRTOS notification, which
+// the button ISR gives, so a press wakes the loop immediately instead of
+// waiting out the period.
+//
+// Usage:
+//   FrameScheduler scheduler;
+//   scheduler.begin();                  // in the task that runs frames
+//   scheduler.wait(FRAME_PLAYING_MS);   // at the end of each frame
+
+class FrameScheduler {
+public:
+    void begin() {
+        _task = xTaskGetCurrentTaskHandle();
+        _nextDeadlineUs = esp_timer_get_time();
+        resetStats();
+    }
+
+    // Restart the timestep from now (after a pause such as light sleep, so
+    // it isn't counted as an overrun)
+    void resync() {
+        _nextDeadlineUs = esp_timer_get_time();
+    }
+
+    // Task to notify from ISRs (see ButtonState::wakeTask)
+    TaskHandle_t task() const { return _task; }
+
+    // Sleep until the next frame deadline, or until input arrives
+    void wait(uint16_t periodMs) {
+        int64_t periodUs = (int64_t)periodMs * 1000;
+        int64_t now = esp_timer_get_time();
+
+        // Deadline for this frame; resync if we fell more than a frame behind
+        int64_t deadline = _nextDeadlineUs + periodUs;
+        if (deadline < now - periodUs) {
+            deadline = now + periodUs;
+            _overruns++;
+        }
+
+        int64_t remaining = deadline - now;
+        if (remaining > 0) {
+            TickType_t ticks = pdMS_TO_TICKS((remaining + 999) / 1000);
+            if (ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1) > 0) {
+                // Woken early by input: run a frame now, keep the deadline
+                _inputWakes++;
+                return;
+            }
+        }
+
+        // Woke on (or after) the deadline: record how late we are
+        now = esp_timer_get_time();
+        uint32_t late = (now > deadline) ? (uint32_t)(now - deadline) : 0;
+        _lateSumUs += late;
+        if (late > _lateMaxUs) _lateMaxUs = late;
+        _frames++;
+        _nextDeadlineUs = deadline;
+    }
+
+    // Log jitter stats every SCHED_REPORT_MS, then start a new window
+    template <class Out>
+    void report(Out& out) {
+        unsigned long now = millis();
+        if (now - _windowStart < SCHED_REPORT_MS) return;
+        out.printf("Frames: %lu, jitter avg %lu us / max %lu us, overruns %lu, input wakes %lu\r\n",
+                   (unsigned long)_frames,
+                   (unsigned long)(_frames ? _lateSumUs / _frames : 0),
+                   (unsigned long)_lateMaxUs,
+                   (unsigned long)_overruns,
+                   (unsigned long)_inputWakes);
+        resetStats();
+    }
+
+    void resetStats() {
+        _windowStart = millis();
+        _frames = 0;
+        _lateSumUs = 0;
+        _lateMaxUs = 0;
+        _overruns = 0;
+        _inputWakes = 0;
+    }
+
+private:
+    TaskHandle_t _task = nullptr;
+    int64_t _nextDeadlineUs = 0;
+
+    // Current stats window
+    unsigned long _windowStart = 0;
+    uint32_t _frames = 0;
+    uint64_t _lateSumUs = 0;
+    uint32_t _lateMaxUs = 0;
+    uint32_t _overruns = 0;
+    uint32_t _inputWakes = 0;
+};
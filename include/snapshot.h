@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+
+// =============================================================================
+// Snapshot — lock-free single-writer handoff between cores (seqlock)
+// =============================================================================
+// The writer (game loop) never waits: it bumps the sequence to odd, copies,
+// and bumps it back to even. Readers (network task) retry until they see the
+// same even sequence before and after their copy.
+//
+// Usage:
+//   Snapshot<GameCore> snap;
+//   snap.publish(game);                       // game core
+//   GameCore view; uint32_t seq;
+//   if (snap.read(view, &seq)) { ... }        // network core
+
+template <typename T>
+class Snapshot {
+public:
+    void publish(const T& value) {
+        uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&_data, &value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_release);
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Copy out a consistent value. Returns false if the writer kept
+    // interrupting (caller just tries again next time round).
+    bool read(T& out, uint32_t *seqOut = nullptr) const {
+        for (uint8_t attempt = 0; attempt < 8; attempt++) {
+            uint32_t before = _seq.load(std::memory_order_acquire);
+            if (before & 1) continue;  // Write in progress
+            memcpy(&out, &_data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_seq.load(std::memory_order_relaxed) == before) {
+                if (seqOut) *seqOut = before;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Even number that changes on every publish (0 = never published)
+    uint32_t sequence() const {
+        return _seq.load(std::memory_order_acquire) & ~1u;
+    }
+
+private:
+    T _data;
+    std::atomic<uint32_t> _seq{0};
+};
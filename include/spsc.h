@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+// =============================================================================
+// SpscQueue — lock-free single-producer / single-consumer ring buffer
+// =============================================================================
+// One context pushes (an ISR, or another task/core), one pops. Neither side
+// ever blocks: a push into a full queue is dropped and counted.
+//
+// Usage:
+//   SpscQueue<ButtonEdge, 32> q;
+//   q.push(e);                      // producer (IRAM-safe)
+//   if (q.peek(e)) { ...; q.pop(); } // consumer
+
+template <typename T, uint8_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of 2");
+
+public:
+    // Producer side. Drops the item (and counts it) if the queue is full.
+    bool IRAM_ATTR push(const T& item) {
+        uint8_t head = _head.load(std::memory_order_relaxed);
+        uint8_t next = (head + 1) & (N - 1);
+        if (next == _tail.load(std::memory_order_acquire)) {
+            _dropped++;
+            return false;
+        }
+        _buf[head] = item;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: look at the oldest item without removing it
+    bool peek(T& item) const {
+        uint8_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        item = _buf[tail];
+        return true;
+    }
+
+    void pop() {
+        uint8_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return;
+        _tail.store((tail + 1) & (N - 1), std::memory_order_release);
+    }
+
+    uint32_t dropped() const { return _dropped; }
+
+private:
+    T _buf[N];
+    std::atomic<uint8_t> _head{0};
+    std::atomic<uint8_t> _tail{0};
+    volatile uint32_t _dropped = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "game.h"
+#include "rules.h"
+
+// =============================================================================
+// Dashboard state event (Server-Sent Events, see webview.h)
+// =============================================================================
+// One event carries every table:
+//
+//   id: 7
+//   data: {"tables":[{"table":1,"rules":"21 point classic","p1":7,"p2":3,
+//          "serve":1,"state":"playing","deuce":false,"gamePoint":false,"winner":0}]}
+//
+// (one line on the wire, followed by a blank line). Players are numbered 1
+// and 2; winner 0 = none. state is "playing", "serve_change" or "game_over".
+
+inline const char *gameStateName(GameState s) {
+    switch (s) {
+        case GameState::PLAYING:      return "playing";
+        case GameState::SERVE_CHANGE: return "serve_change";
+        case GameState::GAME_OVER:    return "game_over";
+    }
+    return "playing";
+}
+
+// Write the event for `views[0 .. count)` to `buf`. Returns its length, or
+// 0 if it doesn't fit in `size`.
+inline size_t formatStateEvent(char *buf, size_t size, uint32_t id, const GameCore *views, uint8_t count) {
+    size_t len = 0;
+    auto append = [&](int n) {
+        if (n < 0 || len + n >= size) len = size;   // Mark as overflowed
+        else len += n;
+    };
+
+    append(snprintf(buf, size, "id: %lu\ndata: {\"tables\":[", (unsigned long)id));
+    for (uint8_t i = 0; i < count && len < size; i++) {
+        const GameCore& g = views[i];
+        append(snprintf(buf + len, size - len,
+                        "%s{\"table\":%u,\"rules\":\"%s\",\"p1\":%u,\"p2\":%u,\"serve\":%u,"
+                        "\"state\":\"%s\",\"deuce\":%s,\"gamePoint\":%s,\"winner\":%d}",
+                        i ? "," : "", i + 1, ruleSetName(g.rules), g.score[0], g.score[1],
+                        g.servingPlayer + 1, gameStateName(g.state),
+                        g.isDeuce() ? "true" : "false", g.isGamePoint() ? "true" : "false",
+                        g.winner() + 1));
+    }
+    if (len < size) append(snprintf(buf + len, size - len, "]}\n\n"));
+    return (len < size) ? len : 0;
+}
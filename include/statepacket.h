@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "game.h"
+#include "matchstats.h"
+
+// =============================================================================
+// STATE PACKET
+// =============================================================================
+// Fixed 26-byte binary snapshot of the game for machines (hall display,
+// stats collector). Little-endian, no padding:
+//
+//   off size field
+//    0   2   magic   0x5050 ("PP")
+//    2   1   version STATE_PACKET_VERSION
+//    3   1   flags   STATE_FLAG_*
+//    4   4   seq     +1 per packet sent (gaps = lost packets)
+//    8   2   score   P1, P2
+//   10   1   server  0 = P1, 1 = P2
+//   11   1   state   GameState (0 PLAYING, 1 SERVE_CHANGE, 2 GAME_OVER)
+//   12   1   table   0-based table on this controller (v2+)
+//   13   1   rules   RuleSet (0 CLASSIC_21, 1 ITTF_11) (v4+, 0 before)
+//   14   2   served  points played on P1's, P2's serve this game (v3+)
+//   16   2   held    ...of which the server won
+//   18   2   longest longest run of points this game, P1, P2
+//   20   1   deuces  times tied at deuce this game
+//   21   2   wins    games won this match, P1, P2 (saturate at 255)
+//   23   2   avgGameS average finished game length in seconds (timed games)
+//   25   1   reserved 0
+//
+// Later versions only append bytes: a v1 parser reading the first 12 (or a
+// v2 parser reading 14) still works.
+
+#define STATE_PACKET_MAGIC      0x5050
+#define STATE_PACKET_VERSION    4
+
+#define STATE_FLAG_DEUCE        0x01
+#define STATE_FLAG_GAME_POINT   0x02
+#define STATE_FLAG_HEARTBEAT    0x04    // Resend of unchanged state
+
+struct __attribute__((packed)) StatePacket {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint32_t seq;
+    uint8_t score[2];
+    uint8_t server;
+    uint8_t state;
+    uint8_t table;
+    uint8_t rules;
+    uint8_t served[2];
+    uint8_t held[2];
+    uint8_t longest[2];
+    uint8_t deuces;
+    uint8_t wins[2];
+    uint16_t avgGameS;
+    uint8_t reserved2;
+
+    // Fill from the game (and the table's match totals, if known); seq and
+    // the heartbeat flag are set by the sender
+    void fill(const GameCore& game, uint8_t tableId = 0, const MatchStats *match = nullptr) {
+        magic = STATE_PACKET_MAGIC;
+        version = STATE_PACKET_VERSION;
+        flags = (game.isDeuce() ? STATE_FLAG_DEUCE : 0) |
+                (game.isGamePoint() ? STATE_FLAG_GAME_POINT : 0);
+        score[0] = game.score[0];
+        score[1] = game.score[1];
+        server = game.servingPlayer;
+        state = (uint8_t)game.state;
+        table = tableId;
+        rules = (uint8_t)game.rules;
+        for (uint8_t p = 0; p < 2; p++) {
+            served[p] = game.stats.served[p];
+            held[p] = game.stats.held[p];
+            longest[p] = game.stats.longest[p];
+            wins[p] = match ? (uint8_t)(match->wins[p] < 255 ? match->wins[p] : 255) : 0;
+        }
+        deuces = game.stats.deuces;
+        avgGameS = match ? (uint16_t)(match->averageMs() / 1000) : 0;
+        reserved2 = 0;
+    }
+
+    // Same game state (ignores seq and heartbeat)
+    bool sameState(const StatePacket& other) const {
+        return table == other.table && rules == other.rules && score[0] == other.score[0] && score[1] == other.score[1] &&
+               server == other.server && state == other.state &&
+               memcmp(served, other.served, sizeof(StatePacket) - offsetof(StatePacket, served)) == 0 &&
+               (flags & ~STATE_FLAG_HEARTBEAT) == (other.flags & ~STATE_FLAG_HEARTBEAT);
+    }
+};
+
+static_assert(sizeof(StatePacket) == 26, "StatePacket layout changed");
+
+// =============================================================================
+// METRICS PACKET
+// =============================================================================
+// Memory telemetry (memstats.h), multicast to the same group on
+// UDP_METRICS_PORT every MEM_REPORT_MS. Little-endian, no padding:
+//
+//   off size field
+//    0   2   magic     0x4D50 ("PM")
+//    2   1   version   METRICS_PACKET_VERSION
+//    3   1   tasks     entries used in stackFree
+//    4   4   seq       +1 per metrics packet sent
+//    8   4   uptimeS   seconds since boot
+//   12   4   freeHeap      bytes
+//   16   4   minFreeHeap   lowest free heap since boot
+//   20   4   largestBlock  largest allocatable block (fragmentation = 1 - this / freeHeap)
+//   24   2xN stackFree     bytes of stack never touched, per task in the order
+//                          watched: game, led (LED_ASYNC_SHOW), net
+//                          (N = MEM_MAX_TASKS = 4; unused slots 0)
+
+#define METRICS_PACKET_MAGIC    0x4D50
+#define METRICS_PACKET_VERSION  1
+
+struct __attribute__((packed)) MetricsPacket {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t tasks;
+    uint32_t seq;
+    uint32_t uptimeS;
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;
+    uint32_t largestBlock;
+    uint16_t stackFree[MEM_MAX_TASKS];
+};
+
+static_assert(sizeof(MetricsPacket) == 24 + 2 * MEM_MAX_TASKS, "MetricsPacket layout changed");
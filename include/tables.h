@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdint.h>
+#include "config.h"
+#include "rules.h"
+
+// =============================================================================
+// COMPILE-TIME LOOKUP TABLES
+// =============================================================================
+// Generated by the compiler from the rule and layout macros in config.h, so
+// the rule and render hot paths are plain table reads with no runtime setup.
+// Change config.h and the tables follow.
+
+namespace tables {
+
+// =============================================================================
+// SERVE SCHEDULE
+// =============================================================================
+// One table per rule set (rules.h), built on first use of that rule set.
+
+// Reference rule: who serves at (p1, p2) given who served first.
+// Only used to build the table, and for off-table scores.
+template <class Rules>
+constexpr uint8_t computeServingPlayer(uint8_t p1, uint8_t p2, uint8_t firstServer) {
+    uint16_t total = (uint16_t)p1 + (uint16_t)p2;
+    bool deuce = p1 >= Rules::deuceThreshold && p2 >= Rules::deuceThreshold;
+
+    if (!deuce) {
+        // Game point: trailing player serves until they tie or lose
+        if (Rules::trailingServes &&
+            (p1 >= Rules::pointsToWin - 1 || p2 >= Rules::pointsToWin - 1)) {
+            return (p1 >= Rules::pointsToWin - 1) ? 1 : 0;
+        }
+
+        // Normal play: switch every serveSwitchEvery points
+        uint8_t serveBlock = total / Rules::serveSwitchEvery;
+        return (firstServer + serveBlock) % 2;
+    }
+
+    // Deuce: player without advantage serves
+    if (Rules::trailingServes) {
+        if (p1 > p2) return 1;  // P2 serves (P1 has advantage)
+        if (p2 > p1) return 0;  // P1 serves (P2 has advantage)
+    }
+
+    // Tied in deuce: alternate every deuceServeSwitch points
+    uint16_t pointsBeforeDeuce = Rules::deuceThreshold * 2;
+    uint16_t blocksBeforeDeuce = pointsBeforeDeuce / Rules::serveSwitchEvery;
+    uint16_t deucePoints = total - pointsBeforeDeuce;
+    uint16_t deuceBlocks = deucePoints / Rules::deuceServeSwitch;
+
+    return (firstServer + blocksBeforeDeuce + deuceBlocks) % 2;
+}
+
+// Deuce repeats every deuceServeSwitch points per player, so scores are
+// folded back into [deuceThreshold, deuceThreshold + deuceServeSwitch)
+// before lookup. Past the fold a player can lead by at most winBy.
+template <class Rules>
+constexpr uint8_t SERVE_TABLE_DIM = Rules::deuceThreshold + Rules::deuceServeSwitch + Rules::winBy;
+
+template <class Rules>
+struct ServeTable {
+    // Bit n = server when player n served first
+    uint8_t server[SERVE_TABLE_DIM<Rules>][SERVE_TABLE_DIM<Rules>];
+};
+
+template <class Rules>
+constexpr ServeTable<Rules> buildServeTable() {
+    ServeTable<Rules> t{};
+    for (uint8_t p1 = 0; p1 < SERVE_TABLE_DIM<Rules>; p1++) {
+        for (uint8_t p2 = 0; p2 < SERVE_TABLE_DIM<Rules>; p2++) {
+            t.server[p1][p2] = computeServingPlayer<Rules>(p1, p2, 0) |
+                               (computeServingPlayer<Rules>(p1, p2, 1) << 1);
+        }
+    }
+    return t;
+}
+
+template <class Rules>
+constexpr ServeTable<Rules> SERVE_TABLE = buildServeTable<Rules>();
+
+template <class Rules>
+inline uint8_t servingPlayer(uint8_t p1, uint8_t p2, uint8_t firstServer) {
+    constexpr uint8_t dim = SERVE_TABLE_DIM<Rules>;
+    if (p1 >= Rules::deuceThreshold && p2 >= Rules::deuceThreshold) {
+        uint8_t low = (p1 < p2) ? p1 : p2;
+        uint8_t fold = ((low - Rules::deuceThreshold) / Rules::deuceServeSwitch) * Rules::deuceServeSwitch;
+        p1 -= fold;
+        p2 -= fold;
+    }
+    if (p1 >= dim || p2 >= dim) {
+        return computeServingPlayer<Rules>(p1, p2, firstServer);  // Not reachable in play
+    }
+    return (SERVE_TABLE<Rules>.server[p1][p2] >> firstServer) & 1;
+}
+
+// =============================================================================
+// SCORE PIXELS AND COLORS
+// =============================================================================
+
+// Score positions per side (every other LED)
+constexpr uint8_t P1_SCORE_POSITIONS = (SCORE_LEDS_PER_SIDE - P1_LED_OFFSET) / 2 + 1;
+constexpr uint8_t P2_SCORE_POSITIONS = (SCORE_LEDS_PER_SIDE + 1) / 2;
+constexpr uint8_t MAX_SCORE_POSITIONS =
+    (P1_SCORE_POSITIONS > P2_SCORE_POSITIONS) ? P1_SCORE_POSITIONS : P2_SCORE_POSITIONS;
+
+// How many points each player's side can show
+constexpr uint8_t SCORE_POSITIONS[2] = {P1_SCORE_POSITIONS, P2_SCORE_POSITIONS};
+
+struct PixelTable {
+    uint16_t index[2][MAX_SCORE_POSITIONS];
+};
+
+// Physical LED for point number (i + 1) of each player.
+// P1 grows right from P1_LED_OFFSET, P2 grows left from the last LED.
+constexpr PixelTable buildPixelTable() {
+    PixelTable t{};
+    for (uint8_t i = 0; i < MAX_SCORE_POSITIONS; i++) {
+        t.index[0][i] = P1_LED_OFFSET + i * 2;
+        t.index[1][i] = TOTAL_LEDS - 1 - i * 2;
+    }
+    return t;
+}
+
+constexpr PixelTable SCORE_PIXEL = buildPixelTable();
+
+// Serve indicator just past each score area, deuce advantage LED past that
+constexpr uint16_t SERVE_PIXEL[2] = {
+    P1_LED_OFFSET + SCORE_LEDS_PER_SIDE,
+    TOTAL_LEDS - SCORE_LEDS_PER_SIDE - 1
+};
+constexpr uint16_t ADVANTAGE_PIXEL[2] = {
+    P1_LED_OFFSET + SCORE_LEDS_PER_SIDE + 2,
+    TOTAL_LEDS - SCORE_LEDS_PER_SIDE - 3
+};
+
+struct ColorTable {
+    uint8_t group[MAX_SCORE_POSITIONS];
+};
+
+// SCORE_COLORS index for point number (i + 1)
+constexpr ColorTable buildColorTable() {
+    ColorTable t{};
+    for (uint8_t i = 0; i < MAX_SCORE_POSITIONS; i++) {
+        uint8_t group = i / POINTS_PER_COLOR;
+        t.group[i] = (group < NUM_SCORE_COLORS) ? group : NUM_SCORE_COLORS - 1;
+    }
+    return t;
+}
+
+constexpr ColorTable POINT_COLOR = buildColorTable();
+
+static_assert(P1_LED_OFFSET <= SCORE_LEDS_PER_SIDE, "P1 score area is empty");
+static_assert(2 * SCORE_LEDS_PER_SIDE + P1_LED_OFFSET + 2 <= TOTAL_LEDS,
+              "Score areas overlap: check TOTAL_LEDS / SCORE_LEDS_PER_SIDE");
+
+// =============================================================================
+// VICTORY RAINBOW
+// =============================================================================
+// Pixel i of a frame turned by hue h has hue (i * VICTORY_HUE_PER_LED + h).
+// With an odd per-LED step that equals ring[i + offset(h)], where ring[k] has
+// hue k * VICTORY_HUE_PER_LED and offset(h) multiplies by the step's inverse
+// mod 256 — so a frame is a window into one precomputed ring.
+
+static_assert(VICTORY_HUE_PER_LED % 2 == 1, "VICTORY_HUE_PER_LED must be odd");
+
+constexpr uint8_t inverseMod256(uint8_t odd) {
+    uint8_t inv = 1;
+    while ((uint8_t)(inv * odd) != 1) inv += 2;
+    return inv;
+}
+
+constexpr uint16_t VICTORY_RING_LEN = 256 + TOTAL_LEDS;
+constexpr uint8_t VICTORY_HUE_STEP_INV = inverseMod256(VICTORY_HUE_PER_LED);
+
+inline uint8_t victoryRingOffset(uint8_t hue) {
+    return (uint8_t)(hue * VICTORY_HUE_STEP_INV);
+}
+
+}  // namespace tables
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "config.h"
+#include "statepacket.h"
+
+// =============================================================================
+// StateBroadcaster — pushes StatePackets to a UDP multicast group
+// =============================================================================
+// Sent from the network task on every state change, plus a heartbeat every
+// UDP_HEARTBEAT_MS so late joiners and lossy links converge. One datagram
+// reaches every listener: no connection per viewer. All tables share one
+// socket and one seq counter; receivers tell them apart by the table byte.
+//
+// Usage:
+//   StateBroadcaster udpState;
+//   udpState.begin();                // after WiFi connects
+//   udpState.update(view, tableId, &match);  // network task, every pass per table
+
+class StateBroadcaster {
+public:
+    void begin() {
+        _group = IPAddress(UDP_STATE_GROUP);
+        _ready = true;
+    }
+
+    // Send if `view` (or `match`) differs from the last packet, or a
+    // heartbeat is due
+    void update(const GameCore& view, uint8_t tableId = 0, const MatchStats *match = nullptr,
+                unsigned long now = millis()) {
+        if (!_ready || tableId >= TABLE_COUNT) return;
+        Stream& st = _stream[tableId];
+
+        StatePacket p;
+        p.fill(view, tableId, match);
+        bool changed = !st.sentAny || !p.sameState(st.last);
+        if (!changed && now - st.lastSentAt < UDP_HEARTBEAT_MS) return;
+
+        if (!changed) p.flags |= STATE_FLAG_HEARTBEAT;
+        p.seq = ++_seq;
+        _udp.beginPacket(_group, UDP_STATE_PORT);
+        _udp.write((const uint8_t *)&p, sizeof(p));
+        if (_udp.endPacket()) _sent++;
+        else _failed++;
+
+        st.last = p;
+        st.sentAny = true;
+        st.lastSentAt = now;
+    }
+
+    // Memory telemetry, to UDP_METRICS_PORT (seq is filled in here)
+    void sendMetrics(MetricsPacket& p) {
+        if (!_ready) return;
+        p.seq = ++_metricsSeq;
+        _udp.beginPacket(_group, UDP_METRICS_PORT);
+        _udp.write((const uint8_t *)&p, sizeof(p));
+        if (_udp.endPacket()) _sent++;
+        else _failed++;
+    }
+
+    uint32_t sent() const { return _sent; }
+    uint32_t failed() const { return _failed; }
+
+private:
+    struct Stream {
+        bool sentAny = false;
+        StatePacket last;
+        unsigned long lastSentAt = 0;
+    };
+
+    WiFiUDP _udp;
+    IPAddress _group;
+    bool _ready = false;
+    Stream _stream[TABLE_COUNT];
+    uint32_t _seq = 0;
+    uint32_t _metricsSeq = 0;
+    uint32_t _sent = 0;
+    uint32_t _failed = 0;
+};
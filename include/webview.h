@@ -0,0 +1,260 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include "config.h"
+#include "statejson.h"
+
+// =============================================================================
+// WebDashboard — browser scoreboard pushed over Server-Sent Events
+// =============================================================================
+// GET / serves a small static page; the page opens GET /events, an SSE
+// stream that receives every table's state (statejson.h) whenever it
+// changes, plus a comment line every WEB_KEEPALIVE_MS.
+//
+// The event is serialized once per change into a shared buffer, and a
+// viewer is only an offset into it, so each extra browser costs a send()
+// per change. Everything runs in the network task on non-blocking sockets,
+// like the telnet clients, so nothing waits on a browser. The last two
+// events are kept: a viewer mid-way through the older one finishes it, a
+// viewer two changes behind is dropped (EventSource reconnects by itself),
+// and so is one whose socket takes nothing for WEB_STALL_MS.
+//
+// Usage:
+//   WebDashboard web;
+//   web.begin();                          // after WiFi connects
+//   web.publish(views, TABLE_COUNT);      // network task, after a snapshot read
+//   web.handle();                         // network task, every pass
+
+class WebDashboard {
+public:
+    void begin() {
+        _server.begin();
+        _server.setNoDelay(true);
+        _ready = true;
+    }
+
+    // Serialize the current state; viewers get it if it changed
+    void publish(const GameCore *views, uint8_t count) {
+        // Built aside: both event buffers may have a viewer mid-send
+        size_t len = formatStateEvent(_scratch, sizeof(_scratch), _version + 1, views, count);
+        if (len == 0) return;
+        // Same state as the last event (the id differs, so compare past it)
+        if (_version && sameData(_scratch, len, _event[_version & 1], _eventLen[_version & 1])) return;
+
+        // _event[next] holds the previous event: anyone still sending it is
+        // two changes behind now
+        uint8_t next = (_version + 1) & 1;
+        for (Viewer& v : _viewers) {
+            if (v.state == Viewer::STREAM && v.out && v.sending && v.sending != _version) close(v);
+        }
+        memcpy(_event[next], _scratch, len);
+        _eventLen[next] = len;
+        _version++;
+    }
+
+    void handle(unsigned long now = millis()) {
+        if (!_ready) return;
+        accept(now);
+        for (Viewer& v : _viewers) {
+            if (v.state == Viewer::FREE) continue;
+            if (!v.sock.connected()) {
+                close(v);
+                continue;
+            }
+            if (v.state == Viewer::REQUEST) readRequest(v);
+            if (v.state == Viewer::STREAM && !v.out) nextEvent(v, now);
+            if (v.out && !flush(v, now)) {
+                close(v);
+                continue;
+            }
+            if (v.state == Viewer::RESPONSE && !v.out) close(v);     // Page sent
+            else if (now - v.lastProgress >= WEB_STALL_MS) close(v);  // Stalled / no request
+        }
+    }
+
+    uint8_t viewerCount() const {
+        uint8_t n = 0;
+        for (const Viewer& v : _viewers) n += (v.state == Viewer::STREAM);
+        return n;
+    }
+
+    uint32_t refused() const { return _refused; }
+    uint32_t dropped() const { return _dropped; }
+    uint32_t events() const { return _version; }
+
+private:
+    struct Viewer {
+        enum State : uint8_t { FREE, REQUEST, RESPONSE, STREAM };
+
+        WiFiClient sock;
+        State state = FREE;
+        char line[WEB_REQUEST_LINE_MAX];    // Request line ("GET /events HTTP/1.1")
+        uint8_t lineLen = 0;
+        bool lineDone = false;
+        uint8_t newlines = 0;               // Consecutive, '\r' ignored: 2 = end of headers
+        const char *out = nullptr;          // Chunk being sent
+        size_t outLen = 0;
+        size_t outOff = 0;
+        uint32_t sending = 0;               // Event version in `out` (0 = not an event)
+        uint32_t shown = 0;                 // Last event version fully sent
+        unsigned long lastProgress = 0;
+        unsigned long lastSentAt = 0;
+    };
+
+    WiFiServer _server{WEB_PORT};
+    bool _ready = false;
+    Viewer _viewers[WEB_MAX_CLIENTS];
+    char _event[2][WEB_EVENT_SIZE];
+    char _scratch[WEB_EVENT_SIZE];          // publish() formats here first
+    size_t _eventLen[2] = {0, 0};
+    uint32_t _version = 0;                  // Events published; _event[_version & 1] is current
+    uint32_t _refused = 0;
+    uint32_t _dropped = 0;
+
+    static constexpr const char *PAGE =
+        "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=utf-8\r\n"
+        "Cache-Control: no-cache\r\nConnection: close\r\n\r\n"
+        R"HTML(<!DOCTYPE html><html><head><meta charset="utf-8">
+<meta name="viewport" content="width=device-width,initial-scale=1"><title>Ping Pong</title>
+<style>body{font-family:sans-serif;background:#111;color:#eee;text-align:center;margin:0}
+.t{margin:6vh auto}.s{font-size:22vw;font-weight:bold;line-height:1}.srv{color:#fd0}
+.m{font-size:5vw;color:#999;min-height:1.2em}</style></head>
+<body><div id="v"><p class="m">Connecting...</p></div><script>
+var v=document.getElementById('v'),es=new EventSource('/events');
+function side(t,p){return '<span'+(t.serve==p?' class="srv"':'')+'>'+(p==1?t.p1:t.p2)+'</span>';}
+es.onmessage=function(e){var d=JSON.parse(e.data),h='';
+d.tables.forEach(function(t){
+h+='<div class="t"><div class="m">'+(d.tables.length>1?'Table '+t.table+' &middot; ':'')+t.rules+'</div>'+
+'<div class="s">'+side(t,1)+' : '+side(t,2)+'</div><div class="m">'+
+(t.winner?'Player '+t.winner+' wins':t.deuce?'Deuce':t.gamePoint?'Game point':'')+'</div></div>';});
+v.innerHTML=h;};
+</script></body></html>
+)HTML";
+
+    static constexpr const char *STREAM_HEADER =
+        "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\nConnection: keep-alive\r\n"
+        "Access-Control-Allow-Origin: *\r\n\r\nretry: 2000\n\n";
+
+    static constexpr const char *NOT_FOUND =
+        "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\n"
+        "Not found\n";
+
+    static constexpr const char *KEEPALIVE = ":\n\n";
+
+    void accept(unsigned long now) {
+        while (_server.hasClient()) {
+            WiFiClient s = _server.available();
+            Viewer *slot = nullptr;
+            for (Viewer& v : _viewers) {
+                if (v.state == Viewer::FREE) {
+                    slot = &v;
+                    break;
+                }
+            }
+            if (!slot) {
+                s.stop();   // Full: refuse rather than drop someone
+                _refused++;
+                continue;
+            }
+            slot->sock = s;
+            slot->sock.setNoDelay(true);
+            slot->state = Viewer::REQUEST;
+            slot->lineLen = 0;
+            slot->lineDone = false;
+            slot->newlines = 0;
+            slot->out = nullptr;
+            slot->sending = 0;
+            slot->shown = 0;
+            slot->lastProgress = now;   // Deadline for the request (WEB_STALL_MS)
+        }
+    }
+
+    void close(Viewer& v) {
+        if (v.state == Viewer::STREAM) _dropped++;
+        v.sock.stop();
+        v.state = Viewer::FREE;
+        v.out = nullptr;
+    }
+
+    // Read the request line, then skip headers up to the blank line
+    void readRequest(Viewer& v) {
+        for (uint16_t budget = WEB_READ_BUDGET; budget > 0 && v.sock.available(); budget--) {
+            int c = v.sock.read();
+            if (c < 0) return;
+            if (c == '\r') continue;
+            if (c != '\n') {
+                v.newlines = 0;
+                if (!v.lineDone && v.lineLen < sizeof(v.line) - 1) v.line[v.lineLen++] = (char)c;
+                continue;
+            }
+            v.lineDone = true;
+            if (++v.newlines == 2) {
+                v.line[v.lineLen] = '\0';
+                route(v);
+                return;
+            }
+        }
+    }
+
+    void route(Viewer& v) {
+        if (strncmp(v.line, "GET /events", 11) == 0 && (v.line[11] == ' ' || v.line[11] == '?')) {
+            v.state = Viewer::STREAM;
+            start(v, STREAM_HEADER, strlen(STREAM_HEADER), 0);
+        } else if (strncmp(v.line, "GET / ", 6) == 0 || strncmp(v.line, "GET /index.html ", 16) == 0) {
+            v.state = Viewer::RESPONSE;
+            start(v, PAGE, strlen(PAGE), 0);
+        } else {
+            v.state = Viewer::RESPONSE;
+            start(v, NOT_FOUND, strlen(NOT_FOUND), 0);
+        }
+    }
+
+    // Streaming viewer with nothing in flight: the newest event, or a keepalive
+    void nextEvent(Viewer& v, unsigned long now) {
+        if (_version && v.shown != _version) {
+            start(v, _event[_version & 1], _eventLen[_version & 1], _version);
+            v.lastSentAt = now;
+        } else if (now - v.lastSentAt >= WEB_KEEPALIVE_MS) {
+            start(v, KEEPALIVE, strlen(KEEPALIVE), 0);
+            v.lastSentAt = now;
+        }
+    }
+
+    static void start(Viewer& v, const char *data, size_t len, uint32_t version) {
+        v.out = data;
+        v.outLen = len;
+        v.outOff = 0;
+        v.sending = version;
+    }
+
+    // Send what the socket takes now. False if the connection failed.
+    static bool flush(Viewer& v, unsigned long now) {
+        while (v.outOff < v.outLen) {
+            int sent = send(v.sock.fd(), v.out + v.outOff, v.outLen - v.outOff, MSG_DONTWAIT);
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+                return false;
+            }
+            if (sent == 0) return true;
+            v.outOff += sent;
+            v.lastProgress = now;
+        }
+        if (v.sending) v.shown = v.sending;
+        v.out = nullptr;
+        if (v.state == Viewer::STREAM) v.lastProgress = now;   // Idle isn't stalled
+        return true;
+    }
+
+    // Events are equal apart from their "id:" line
+    static bool sameData(const char *a, size_t alen, const char *b, size_t blen) {
+        const char *da = strchr(a, '\n');
+        const char *db = strchr(b, '\n');
+        if (!da || !db) return false;
+        size_t la = alen - (da - a);
+        size_t lb = blen - (db - b);
+        return la == lb && memcmp(da, db, la) == 0;
+    }
+};
@@ -3,11 +3,14 @@
 // =============================================================================
 // ESP32-WROOM-32E (QuinLED) + WS2815 LED Strip
 //
-// Controls:
+// One controller can run TABLE_COUNT independent tables (see config.h).
+//
+// Controls (per table):
 //   - Player 1 button: adds a point for Player 1 (left side)
 //   - Player 2 button: adds a point for Player 2 (right side)
 //   - Double-tap a button: undo last point for that player
 //   - Hold EITHER button for 3 seconds: reset the game
+//   - Hold BOTH buttons for 3 seconds at 0-0: switch 21 / 11 point rules
 //
 // LED Layout (single strip across table center):
 //   [P1 score: grows right ->] [gap w/ serve indicator] [<- grows left: P2 score]
@@ -23,195 +26,651 @@
 #include <ArduinoOTA.h>
 #include "config.h"
 #include "game.h"
+#include "journal.h"
+#include "persist.h"
+#include "commands.h"
+#include "udpstate.h"
+#include "webview.h"
+#include "mirrorlink.h"
 #include "display.h"
+#include "ledtask.h"
+#include "idlesleep.h"
+#include "memstats.h"
+#include "buttons.h"
 #include "netlog.h"
+#include "snapshot.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "latency.h"
 
 // =============================================================================
 // GLOBALS
 // =============================================================================
 
-PingPongGame game;
-ScoreDisplay display;
+// Everything one table owns. Tables share only the scheduler, the network
+// task and the LED frame (one FastLED.show() clocks every strip at once).
+struct Table {
+    uint8_t id = 0;
+    PointJournal journal;               // Every scoring event; undo = edit + replay
+    PingPongGame classic;               // One game per rule set; journal.rules()
+    IttfGame ittf;                      // picks the live one
+    MatchStore store;                   // Journal persistence (RTC + NVS)
+    uint32_t savedRevision = 0;
+    ScoreDisplay display;
+    ButtonState btn1, btn2;
+    bool resetTriggered = false;
+    bool speculative[2] = {false, false};  // Point scored on a tap still in its double-tap window
+    uint32_t speculativeUs[2] = {0, 0};    // ...and its edge (latency benchmark)
+    MatchStats match;                   // Finished games (matchstats.h)
+    GameClock clock;                    // Length of the current game
+
+    // Game core -> network core handoff (see TASK LAYOUT in config.h)
+    Snapshot<GameCore> snapshot;
+    GameCore lastPublished;
+    Snapshot<MatchStats> matchSnapshot;
+    GameCommandQueue commands;          // Telnet -> game core
+
+    GameCore& game() {
+        if (journal.rules() == RuleSet::ITTF_11) return ittf;
+        return classic;
+    }
+};
+
+Table table[TABLE_COUNT];
+RTC_NOINIT_ATTR MatchImage rtcMatch[TABLE_COUNT];
+
+static const uint8_t BUTTON_PINS[2][2] = {
+    {BUTTON_PLAYER1_PIN, BUTTON_PLAYER2_PIN},
+    {BUTTON2_PLAYER1_PIN, BUTTON2_PLAYER2_PIN}
+};
+
 DualPrint logger;
+StateBroadcaster udpState;
+WebDashboard web;
+MirrorSender mirrors;
+FrameScheduler scheduler;
+IdleSleep idleSleep;
+MemoryMonitor memory;               // Network task only (after setup())
+
+std::atomic<bool> otaActive{false};
+unsigned long otaStartedAt = 0;     // Network task only
+uint8_t otaLoggedPct = 0;
+std::atomic<bool> wifiGotIp{false};
+bool networkReady = false;          // OTA + telnet started (network task only)
+TaskHandle_t networkTaskHandle = nullptr;
 
-// Button state tracking with double-tap and long-press support
-struct ButtonState {
-    uint8_t pin;
-    bool lastState;
-    bool currentState;
-    unsigned long lastPressTime;
-    unsigned long pendingPressTime;
-    bool pressed;        // Single press confirmed (after double-tap window)
-    bool doubleTapped;   // Double tap confirmed
-    bool pendingPress;   // Waiting to see if double-tap follows
-    bool holdFired;      // Long-press already triggered this hold
-
-    void begin(uint8_t _pin) {
-        pin = _pin;
-        pinMode(pin, INPUT_PULLUP);
-        lastState = HIGH;
-        currentState = HIGH;
-        lastPressTime = 0;
-        pendingPressTime = 0;
-        pressed = false;
-        doubleTapped = false;
-        pendingPress = false;
-        holdFired = false;
+// =============================================================================
+// DEBUG OUTPUT
+// =============================================================================
+
+// One log line for a table, tagged "T2 " when there are several; tag and
+// message reach the log in a single write
+LogLine tlog([[maybe_unused]] const Table& t) {
+    LogLine line(logger);
+#if TABLE_COUNT > 1
+    line.printf("T%u ", t.id + 1);
+#endif
+    return line;
+}
+
+// Run `fn` on the table's live game as its BasicGame type. This is the one
+// runtime branch on the rules; everything inside is compiled per rule set.
+template <typename Fn>
+void withGame(Table& t, Fn&& fn) {
+    if (t.journal.rules() == RuleSet::ITTF_11) fn(t.ittf);
+    else fn(t.classic);
+}
+
+// Output helpers take any `out` with a stack-formatting printf() (LogLine,
+// TelnetClient, DualPrint), never plain Print, whose printf() mallocs
+template <class Out>
+void printGameState(const GameCore& view, Out& out) {
+    out.printf("Score: P1=%u P2=%u | Serve: P%u%s", view.score[0], view.score[1],
+               view.servingPlayer + 1, view.isDeuce() ? " [DEUCE]" : "");
+    if (view.isGameWon()) out.printf(" >>> WINNER: P%d <<<", view.winner() + 1);
+    out.println();
+}
+
+// Per-player statistics: this game from `view`, earlier games from `match`
+template <class Out>
+void printMatchStats(const GameCore& view, const MatchStats& match, Out& out) {
+    unsigned long avgS = match.averageMs() / 1000;
+    out.printf("Games %u, average %lu:%02lu | Deuces: game %u, match %u\r\n",
+               match.games, avgS / 60, avgS % 60, view.stats.deuces, match.deuces);
+    for (uint8_t p = 0; p < 2; p++) {
+        const GameStats& g = view.stats;
+        out.printf("P%u: %u wins | Serve held: game %u/%u (%u%%), match %lu/%lu (%u%%) | "
+                   "Longest run: game %u, match %u\r\n",
+                   p + 1, match.wins[p], g.held[p], g.served[p], percentOf(g.held[p], g.served[p]),
+                   (unsigned long)match.held[p], (unsigned long)match.served[p],
+                   percentOf(match.held[p], match.served[p]), g.longest[p], match.longest[p]);
     }
+}
 
-    void update() {
-        pressed = false;
-        doubleTapped = false;
-        currentState = digitalRead(pin);
-
-        // Detect falling edge (HIGH -> LOW) with debounce
-        if (currentState == LOW && lastState == HIGH) {
-            unsigned long now = millis();
-            if (now - lastPressTime > DEBOUNCE_MS) {
-                lastPressTime = now;
-                holdFired = false;
-
-                if (pendingPress && (now - pendingPressTime < DOUBLE_TAP_MS)) {
-                    // Second tap within window — double tap
-                    doubleTapped = true;
-                    pendingPress = false;
-                } else {
-                    // First tap — wait for possible second
-                    pendingPress = true;
-                    pendingPressTime = now;
-                }
-            }
+// A point was scored on a button: if it won the game, that is when it ended
+void stampWin(Table& t, const GameCore& game) {
+    if (game.isGameWon()) t.clock.won(millis());
+}
+
+// A won game is final (the next one starts): add it to the match
+void finishGame(Table& t, const GameCore& game) {
+    t.match.gameFinished(game.stats, game.winner(), t.clock.durationMs());
+    t.matchSnapshot.publish(t.match);
+}
+
+// Hand the current game to the network task if anything changed
+void publishGame(Table& t) {
+    GameCore& game = t.game();
+    if (memcmp(&game, &t.lastPublished, sizeof(game)) == 0) return;
+    memcpy(&t.lastPublished, &game, sizeof(game));
+    t.snapshot.publish(game);
+    if (networkTaskHandle) xTaskNotifyGive(networkTaskHandle);   // Mirrors hear it now, not next pass
+}
+
+// Save the journal (RTC now, NVS later from the network task) if it changed
+void saveMatch(Table& t) {
+    if (t.journal.revision() == t.savedRevision) return;
+    t.savedRevision = t.journal.revision();
+    t.store.save(t.journal);
+}
+
+// =============================================================================
+// NETWORK TASK (NET_CORE)
+// =============================================================================
+// OTA, telnet and score logging run here so a slow WiFi link never stalls
+// input or rendering on the game core. The game is only seen via snapshot.
+
+// Hand a game change to the game core and wake it for the next frame
+void queueGameCommand(Table& t, GameCommandType type, uint8_t a, uint8_t b, Print& out) {
+    if (!t.commands.push({type, a, b})) {
+        out.println("Busy, try again");
+        return;
+    }
+    xTaskNotifyGive(scheduler.task());
+}
+
+// Telnet command line (network task). Replies go to the issuing client;
+// results of game changes are logged by the game core once applied.
+// `context` is the client's selected table.
+void handleCommand(char *line, TelnetClient& out, uint8_t& context) {
+    Tokens tok;
+    tokenize(line, tok);
+    const char *cmd = tok[0];
+    uint16_t a, b;
+    if (context >= TABLE_COUNT) context = 0;
+    Table& t = table[context];
+
+    if (strcmp(cmd, "score") == 0) {
+        GameCore view;
+        if (t.snapshot.read(view)) printGameState(view, out);
+        else out.println("Busy, try again");
+    } else if (strcmp(cmd, "match") == 0) {
+        if (strcmp(tok[1], "reset") == 0) {
+            queueGameCommand(t, GameCommandType::RESET_MATCH, 0, 0, out);
+            return;
+        }
+        GameCore view;
+        MatchStats match;
+        if (t.snapshot.read(view) && t.matchSnapshot.read(match)) printMatchStats(view, match, out);
+        else out.println("Busy, try again");
+    } else if (strcmp(cmd, "set") == 0) {
+        if (tok.count == 3 && parseNumber(tok[1], CMD_MAX_SCORE, a) && parseNumber(tok[2], CMD_MAX_SCORE, b)) {
+            queueGameCommand(t, GameCommandType::SET_SCORE, a, b, out);
+        } else {
+            out.printf("Usage: set <p1> <p2>  (0-%d)\r\n", CMD_MAX_SCORE);
+        }
+    } else if (strcmp(cmd, "undo") == 0) {
+        queueGameCommand(t, GameCommandType::UNDO, 0, 0, out);
+    } else if (strcmp(cmd, "server") == 0) {
+        if (tok.count == 2 && parseNumber(tok[1], 2, a) && a >= 1) {
+            queueGameCommand(t, GameCommandType::SET_SERVER, a - 1, 0, out);
+        } else {
+            out.println("Usage: server <1|2>");
+        }
+    } else if (strcmp(cmd, "reset") == 0) {
+        queueGameCommand(t, GameCommandType::RESET, 0, 0, out);
+    } else if (strcmp(cmd, "rules") == 0) {
+        if (tok.count == 1) {
+            GameCore view;
+            if (t.snapshot.read(view)) out.printf("Rules: %s\r\n", ruleSetName(view.rules));
+            else out.println("Busy, try again");
+        } else if (strcmp(tok[1], "21") == 0) {
+            queueGameCommand(t, GameCommandType::SET_RULES, (uint8_t)RuleSet::CLASSIC_21, 0, out);
+        } else if (strcmp(tok[1], "11") == 0) {
+            queueGameCommand(t, GameCommandType::SET_RULES, (uint8_t)RuleSet::ITTF_11, 0, out);
+        } else {
+            out.println("Usage: rules <11|21>");
         }
+    } else if (strcmp(cmd, "table") == 0) {
+        if (tok.count == 1) {
+            out.printf("Table %u of %d\r\n", context + 1, TABLE_COUNT);
+        } else if (parseNumber(tok[1], TABLE_COUNT, a) && a >= 1) {
+            context = a - 1;
+            out.printf("Commands now go to table %u\r\n", context + 1);
+        } else {
+            out.printf("Usage: table <1-%d>\r\n", TABLE_COUNT);
+        }
+    } else if (strcmp(cmd, "stats") == 0) {
+#ifdef PINGPONG_PROFILE
+        if (strcmp(tok[1], "reset") == 0) {
+            profiler().reset();
+            LedFrame::resetPeak();
+            out.println("Profiler reset");
+            return;
+        }
+        profiler().dump(out);
+#else
+        out.println("Profiling not compiled in (build with -D PINGPONG_PROFILE)");
+#endif
+        for (Table& s : table) {
+            out.printf("Table %u: journal %u events, NVS commits %lu (%lu skipped)\r\n",
+                       s.id + 1, s.journal.size(), (unsigned long)s.store.commits(),
+                       (unsigned long)s.store.skipped());
+        }
+        out.printf("LED power: %lu mA est. at brightness %u (peak %lu, budget %d), %lu frames limited\r\n",
+                   (unsigned long)LedFrame::lastMa(), LedFrame::lastScale(),
+                   (unsigned long)LedFrame::peakMa(), POWER_BUDGET_MA,
+                   (unsigned long)LedFrame::limitedFrames());
+        out.printf("Idle sleep: %lu times, %lu slices (%lu rejected), wake-to-frame last %lu us / max %lu us\r\n",
+                   (unsigned long)idleSleep.sleeps(), (unsigned long)idleSleep.slices(),
+                   (unsigned long)idleSleep.rejected(), (unsigned long)idleSleep.lastLatencyUs(),
+                   (unsigned long)idleSleep.maxLatencyUs());
+#if LED_ASYNC_SHOW
+        out.printf("LED output: background task, %lu frames, longest wait %lu us\r\n",
+                   (unsigned long)LedOutputTask::frames(), (unsigned long)LedOutputTask::maxWaitUs());
+#endif
+        out.printf("Log dropped %lu bytes, telnet clients %u/%d, UDP sent %lu (%lu failed)\r\n",
+                   (unsigned long)logger.droppedBytes(),
+                   logger.clientCount(), TELNET_MAX_CLIENTS,
+                   (unsigned long)udpState.sent(), (unsigned long)udpState.failed());
+        if (memory.sampled()) memory.print(out);
+        out.printf("Web viewers %u/%d, %lu events, %lu dropped, %lu refused\r\n",
+                   web.viewerCount(), WEB_MAX_CLIENTS, (unsigned long)web.events(),
+                   (unsigned long)web.dropped(), (unsigned long)web.refused());
+#if MIRROR_ENABLED
+        out.printf("Mirror broadcast: %lu sent (%lu failed), channel %u\r\n",
+                   (unsigned long)mirrors.sent(), (unsigned long)mirrors.failed(), WiFi.channel());
+#endif
+    } else if (strcmp(cmd, "latency") == 0) {
+#ifdef PINGPONG_LATENCY_BENCH
+        if (strcmp(tok[1], "reset") == 0) {
+            latencyBench().reset();
+            out.println("Latency histograms reset");
+            return;
+        }
+        latencyBench().dump(out);
+#else
+        out.println("Latency benchmark not compiled in (build with -D PINGPONG_LATENCY_BENCH)");
+#endif
+    } else if (strcmp(cmd, "help") == 0) {
+        out.println("score | match [reset] | set <p1> <p2> | undo | server <1|2> | reset | rules [11|21] | table [n] | stats [reset] | latency [reset]");
+    } else {
+        out.print("Unknown command: ");
+        out.println(cmd);
+    }
+}
+
+// WiFi event callback (system event task): only flag, the network task acts
+void onWiFiEvent(WiFiEvent_t event) {
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        wifiGotIp = true;
+    }
+}
+
+// First IP: bring up OTA and telnet (network task)
+void startNetworkServices() {
+    logger.print("WiFi connected! IP: ");
+    logger.println(WiFi.localIP());
+
+    ArduinoOTA.setHostname(OTA_HOSTNAME);
+    #ifdef OTA_PASSWORD
+    ArduinoOTA.setPassword(OTA_PASSWORD);
+    #endif
+
+    ArduinoOTA.onStart([]() {
+        // Game core freezes the score on the strips and stops taking input;
+        // the game is in NVS (and RTC) before the reboot and resumes after it
+        otaActive = true;
+        for (Table& t : table) t.store.flush();
+        WiFi.setSleep(false);           // Modem sleep costs most of the throughput
+        otaStartedAt = millis();
+        otaLoggedPct = 0;
+        logger.println("OTA update starting...");
+    });
+    ArduinoOTA.onEnd([]() {
+        logger.printf("OTA update complete in %lu ms! Rebooting...\r\n", millis() - otaStartedAt);
+        logger.handle();
+    });
+    ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
+        // Called for every received chunk, from inside ArduinoOTA.handle():
+        // log a line per OTA_PROGRESS_STEP and drain it to telnet right away,
+        // since handle() doesn't return until the transfer ends
+        uint8_t pct = total ? (uint8_t)((uint64_t)progress * 100 / total) : 0;
+        bool due = pct >= otaLoggedPct + OTA_PROGRESS_STEP || (pct == 100 && otaLoggedPct < 100);
+        if (!due) return;
+        otaLoggedPct = pct;
+        logger.printf("OTA Progress: %u%%\r\n", pct);
+        logger.handle();
+    });
+    ArduinoOTA.onError([](ota_error_t error) {
+        otaActive = false;
+        WiFi.setSleep(true);
+        logger.printf("OTA Error[%u]: ", error);
+        if (error == OTA_AUTH_ERROR) logger.println("Auth Failed");
+        else if (error == OTA_BEGIN_ERROR) logger.println("Begin Failed");
+        else if (error == OTA_CONNECT_ERROR) logger.println("Connect Failed");
+        else if (error == OTA_RECEIVE_ERROR) logger.println("Receive Failed");
+        else if (error == OTA_END_ERROR) logger.println("End Failed");
+    });
+    ArduinoOTA.begin();
+    logger.onCommand(handleCommand);
+    logger.begin();
+    udpState.begin();
+    web.begin();
+    networkReady = true;
+    logger.printf("OTA ready. Telnet logging on port %d, dashboard on port %d (%lu ms after boot)\r\n",
+                  TELNET_PORT, WEB_PORT, millis());
+}
 
-        // Cancel pending press if button is still held (becoming a long-press)
-        if (pendingPress && isHeld() && (millis() - pendingPressTime >= DOUBLE_TAP_MS)) {
-            pendingPress = false;
+void networkTask(void *) {
+    memory.watch("net", xTaskGetCurrentTaskHandle());   // After setup()'s watches
+    GameCore view[TABLE_COUNT];
+    uint32_t seenSeq[TABLE_COUNT] = {};
+    MatchStats matchView[TABLE_COUNT] = {};
+    uint8_t printed[TABLE_COUNT][3];    // score[0], score[1], servingPlayer
+    memset(printed, 0xFF, sizeof(printed));
+
+    for (;;) {
+        if (wifiGotIp.exchange(false)) {
+            if (!networkReady) {
+                startNetworkServices();
+            } else {
+                logger.print("WiFi reconnected! IP: ");
+                logger.println(WiFi.localIP());
+            }
         }
 
-        // Pending press timed out and button released → single press
-        if (pendingPress && !isHeld() && (millis() - pendingPressTime >= DOUBLE_TAP_MS)) {
-            pressed = true;
-            pendingPress = false;
+        if (networkReady) {
+            PROFILE_SCOPE(OTA_HANDLE);
+            ArduinoOTA.handle();
+        }
+        {
+            PROFILE_SCOPE(TELNET_HANDLE);
+            logger.handle();
         }
 
-        lastState = currentState;
-    }
+        bool changed = false;
+        bool allRead = true;
+        for (Table& t : table) {
+            uint8_t i = t.id;
+            t.store.service();
+
+            // Log the score whenever it (or the server) changes
+            if (t.snapshot.sequence() != seenSeq[i] && t.snapshot.read(view[i], &seenSeq[i])) {
+                changed = true;
+                if (view[i].score[0] != printed[i][0] || view[i].score[1] != printed[i][1] ||
+                    view[i].servingPlayer != printed[i][2]) {
+                    printed[i][0] = view[i].score[0];
+                    printed[i][1] = view[i].score[1];
+                    printed[i][2] = view[i].servingPlayer;
+                    LogLine line = tlog(t);
+                    printGameState(view[i], line);
+                }
+            }
 
-    bool isHeld() const {
-        return (currentState == LOW);
-    }
+            // Binary state for scoreboards: on change, plus heartbeat
+            t.matchSnapshot.read(matchView[i]);     // On a torn read keep the last one
+            if (networkReady && seenSeq[i] != 0) udpState.update(view[i], i, &matchView[i]);
+#if MIRROR_ENABLED
+            if (seenSeq[i] != 0) mirrors.update(view[i], i);    // ESP-NOW: no IP needed
+#endif
+            allRead &= (seenSeq[i] != 0);
+        }
 
-    // Long-press detection: returns true once per hold when held >= LONG_PRESS_MS
-    bool longPressed() {
-        if (isHeld() && !holdFired && (millis() - lastPressTime >= LONG_PRESS_MS)) {
-            holdFired = true;
-            return true;
+        // Browsers: one event per change (the dashboard drops repeats)
+        if (networkReady) {
+            PROFILE_SCOPE(WEB_HANDLE);
+            if (changed && allRead) web.publish(view, TABLE_COUNT);
+            web.handle();
         }
-        return false;
-    }
-};
 
-ButtonState btn1, btn2;
-bool resetTriggered = false;
+        unsigned long now = millis();
+        if (memory.due(now)) {
+            memory.sample(now);
+            memory.print(logger);
+            MetricsPacket m;
+            memory.fill(m);
+            if (networkReady) udpState.sendMetrics(m);
+        }
+
+        LATENCY_INJECT(now);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NET_TASK_PERIOD_MS));   // Early on a published change
+    }
+}
 
 // =============================================================================
-// DEBUG OUTPUT
+// GAME COMMANDS (game core)
 // =============================================================================
-
-void printGameState() {
-    logger.print("Score: P1=");
-    logger.print(game.score[0]);
-    logger.print(" P2=");
-    logger.print(game.score[1]);
-    logger.print(" | Serve: P");
-    logger.print(game.servingPlayer + 1);
-    if (game.isDeuce()) {
-        logger.print(" [DEUCE]");
-    }
+// Everything that touches the rules is a template over the BasicGame type,
+// entered through withGame().
+
+// Rebuild the game from the journal (undo, restore, score correction).
+// A finished game goes straight to its final score.
+template <class Game>
+void rebuildGame(Table& t, Game& game) {
+    t.journal.replay(game);
     if (game.isGameWon()) {
-        logger.print(" >>> WINNER: P");
-        logger.print(game.winner() + 1);
-        logger.print(" <<<");
+        game.state = GameState::GAME_OVER;
+        game.animStartTime = millis() - VICTORY_ANIM_MS - 1;
+    }
+}
+
+template <class Game>
+void resetGame(Table& t, Game& game) {
+    game.reset();
+    t.journal.recordReset();
+    t.clock.start(millis());
+    t.display.startStartup();
+}
+
+// Start a new game under `rules`. The caller must not touch its Game
+// reference afterwards: the live game is now the other variant.
+void switchRules(Table& t, RuleSet rules) {
+    t.journal.startRules(rules, 0);
+    withGame(t, [&](auto& game) { game.reset(); });
+    t.clock.start(millis());
+    t.display.startStartup();
+    tlog(t).printf("Rules: %s\r\n", ruleSetName(rules));
+}
+
+// Apply changes queued by telnet commands
+template <class Game>
+void runGameCommands(Table& t, Game& game) {
+    GameCommand c;
+    while (t.commands.peek(c)) {
+        t.commands.pop();
+        for (uint8_t p = 0; p < 2; p++) {
+            if (t.speculative[p]) LATENCY_CONFIRM(t.speculativeUs[p]);
+            t.speculative[p] = false;               // The command settles the score
+        }
+        switch (c.type) {
+            case GameCommandType::SET_SCORE:
+                t.journal.startFrom(c.a, c.b, game.firstServer);
+                rebuildGame(t, game);
+                t.clock.start(millis());
+                if (game.totalPoints() != 0) t.clock.forget();  // It began before the clock
+                tlog(t).printf("Score set to %u-%u\r\n", game.score[0], game.score[1]);
+                break;
+
+            case GameCommandType::UNDO:
+                if (t.journal.undo()) {
+                    rebuildGame(t, game);
+                    tlog(t).println("Undo!");
+                } else {
+                    tlog(t).println("Nothing to undo");
+                }
+                break;
+
+            case GameCommandType::SET_SERVER:
+                if (game.state == GameState::GAME_OVER) {
+                    tlog(t).println("Game is over");
+                } else if (game.servingPlayer == c.a) {
+                    tlog(t).printf("P%u is already serving\r\n", c.a + 1);
+                } else if (Game::serverAt(game.score[0], game.score[1], 1 - game.firstServer) != c.a) {
+                    tlog(t).println("Serve is fixed by the score");  // Game point / deuce
+                } else {
+                    game.swapFirstServer();
+                    t.journal.recordSwap();
+                    tlog(t).printf("P%u now serving\r\n", c.a + 1);
+                }
+                break;
+
+            case GameCommandType::RESET:
+                tlog(t).println(">>> GAME RESET (telnet) <<<");
+                resetGame(t, game);
+                break;
+
+            case GameCommandType::RESET_MATCH:
+                t.match.clear();
+                t.matchSnapshot.publish(t.match);
+                tlog(t).println("Match statistics cleared");
+                break;
+
+            case GameCommandType::SET_RULES:
+                if (game.totalPoints() != 0 && game.state != GameState::GAME_OVER) {
+                    tlog(t).println("Rules can only change between games (reset first)");
+                } else if ((RuleSet)c.a == Game::RuleType::id) {
+                    tlog(t).printf("Already playing %s\r\n", Game::RuleType::name);
+                } else {
+                    if (game.state == GameState::GAME_OVER) finishGame(t, game);
+                    switchRules(t, (RuleSet)c.a);
+                    return;   // `game` is no longer the live variant
+                }
+                break;
+        }
     }
-    logger.println();
 }
 
 // =============================================================================
 // STATE HANDLERS
 // =============================================================================
 
-void handlePlaying() {
+template <class Game>
+void handlePlaying(Table& t, Game& game) {
+    PROFILE_SCOPE(STATE_PLAYING);
     // Process button presses (only when not doing reset)
-    if (!resetTriggered) {
+    if (!t.resetTriggered) {
         // Double-tap at 0-0: swap first server
-        if (game.totalPoints() == 0 && (btn1.doubleTapped || btn2.doubleTapped)) {
-            game.firstServer = 1 - game.firstServer;
-            game.servingPlayer = game.firstServer;
-            logger.print("Swapped first server to P");
-            logger.println(game.firstServer + 1);
+        if (game.totalPoints() == 0 && (t.btn1.doubleTapped || t.btn2.doubleTapped)) {
+            game.swapFirstServer();
+            t.journal.recordSwap();
+            tlog(t).printf("Swapped first server to P%u\r\n", game.firstServer + 1);
         }
         // Double-tap: undo last point for that player
-        else if (btn1.doubleTapped) {
-            logger.print("Undo P1 point! ");
-            game.removePoint(0);
-            printGameState();
-        } else if (btn2.doubleTapped) {
-            logger.print("Undo P2 point! ");
-            game.removePoint(1);
-            printGameState();
+        else if (t.btn1.doubleTapped) {
+            tlog(t).println("Undo P1 point!");
+            if (t.journal.undoPoint(0)) t.journal.replay(game);
+        } else if (t.btn2.doubleTapped) {
+            tlog(t).println("Undo P2 point!");
+            if (t.journal.undoPoint(1)) t.journal.replay(game);
         }
 
-        // Single tap: score a point
-        if (btn1.pressed) {
-            logger.print("Player 1 scores! ");
+        // Single tap: score a point (the first may end the game)
+        if (t.btn1.pressed && game.state == GameState::PLAYING) {
+            tlog(t).println("Player 1 scores!");
             game.addPoint(0);
-            printGameState();
+            LATENCY_COMMIT(t.btn1.tapUs);
+            t.journal.recordPoint(0);
+            stampWin(t, game);
         }
-        if (btn2.pressed) {
-            logger.print("Player 2 scores! ");
+        if (t.btn2.pressed && game.state == GameState::PLAYING) {
+            tlog(t).println("Player 2 scores!");
             game.addPoint(1);
-            printGameState();
+            LATENCY_COMMIT(t.btn2.tapUs);
+            t.journal.recordPoint(1);
+            stampWin(t, game);
         }
     }
 
     // Render the current score
     if (game.totalPoints() == 0) {
-        display.renderIdle(game);
+        t.display.renderIdle(game);
     } else {
-        display.renderPlaying(game);
+        t.display.renderPlaying(game);
     }
 }
 
-void handleServeChange() {
-    bool done = display.animateServeChange(game);
+// Speculative scoring (SPECULATIVE_TAPS): a tap scores on its first edge,
+// one frame later, instead of once the double-tap window has passed. If it
+// becomes the first half of a double tap or the start of a hold, the point
+// is taken back before that gesture is handled, so every gesture ends up
+// where it would have without speculation.
+template <class Game>
+void handleTaps(Table& t, Game& game) {
+    ButtonState *btn[2] = {&t.btn1, &t.btn2};
+    for (uint8_t p = 0; p < 2; p++) {
+        ButtonState& b = *btn[p];
+        if (t.speculative[p]) {
+            if (b.pressed) {
+                b.pressed = false;      // Already scored on the tap
+                LATENCY_CONFIRM(t.speculativeUs[p]);
+                t.speculative[p] = false;
+            } else if (b.doubleTapped || b.cancelled) {
+                tlog(t).printf("Taking back P%u point (%s)\r\n", p + 1,
+                               b.doubleTapped ? "double tap" : "hold");
+                if (t.journal.undoPoint(p)) t.journal.replay(game);
+                LATENCY_DISCARD(t.speculativeUs[p]);
+                t.speculative[p] = false;
+            }
+        }
+
+        // A tap that can't score yet (reset hold, animation) still scores
+        // on the confirmed press, as without speculation
+        if (b.tapped && !t.resetTriggered && game.state == GameState::PLAYING) {
+            tlog(t).printf("Player %u scores!\r\n", p + 1);
+            game.addPoint(p);
+            LATENCY_SPECULATE(b.tapUs);
+            t.journal.recordPoint(p);
+            stampWin(t, game);
+            t.speculative[p] = true;
+            t.speculativeUs[p] = b.tapUs;
+        }
+    }
+}
+
+void handleServeChange(Table& t, GameCore& game) {
+    PROFILE_SCOPE(STATE_SERVE_CHANGE);
+    bool done = t.display.animateServeChange(game);
     if (done) {
         game.state = GameState::PLAYING;
-        logger.print("Serve now: Player ");
-        logger.println(game.servingPlayer + 1);
+        tlog(t).printf("Serve now: Player %u\r\n", game.servingPlayer + 1);
     }
 }
 
-void handleGameOver() {
-    bool done = display.animateVictory(game);
+template <class Game>
+void handleGameOver(Table& t, Game& game) {
+    PROFILE_SCOPE(STATE_GAME_OVER);
+    bool done = t.display.animateVictory(game);
 
     if (done) {
         // After victory animation, show final score with loser dimmed
-        display.renderGameOver(game);
+        t.display.renderGameOver(game);
     }
 
     // Any button press after game over starts a new game
-    if (btn1.pressed || btn2.pressed) {
+    if (t.btn1.pressed || t.btn2.pressed) {
         unsigned long elapsed = millis() - game.animStartTime;
         if (elapsed > 3000) {  // Wait at least 3 seconds before allowing reset
-            logger.println(">>> NEW GAME <<<");
+            tlog(t).println(">>> NEW GAME <<<");
             int8_t loser = 1 - game.winner();  // Loser serves first next game
+            finishGame(t, game);
             game.reset();
             game.firstServer = loser;
             game.servingPlayer = game.firstServer;
-            display.clearAll();
-            display.show();
-            delay(300);
-            printGameState();
+            t.journal.startGame(loser);
+            t.clock.start(millis());
+            t.display.clearAll();
+            t.display.show();
         }
     }
 }
@@ -220,123 +679,257 @@ void handleGameOver() {
 // SETUP
 // =============================================================================
 
+void setupTable(Table& t, uint8_t id) {
+    t.id = id;
+    t.btn1.begin(BUTTON_PINS[id][0]);
+    t.btn2.begin(BUTTON_PINS[id][1]);
+#if BUTTON_USE_INTERRUPTS
+    t.btn1.wakeTask = scheduler.task();
+    t.btn2.wakeTask = scheduler.task();
+#endif
+
+    // Resume the game in progress if we rebooted mid-match
+    t.classic.renderOps = &t.display.renderQueue();
+    t.ittf.renderOps = &t.display.renderQueue();
+    t.classic.reset();
+    t.store.begin(&rtcMatch[id], id);
+    RestoreSource restored = t.store.restore(t.journal);
+    if (restored != RestoreSource::NONE) {
+        withGame(t, [&](auto& game) { rebuildGame(t, game); });
+        tlog(t).printf("Restored game %u-%u (%s) from %s\r\n", t.game().score[0], t.game().score[1],
+                       ruleSetName(t.journal.rules()),
+                       restored == RestoreSource::RTC ? "RTC" : "NVS");
+    } else {
+        t.journal.startGame(t.classic.firstServer);
+    }
+    if (t.game().totalPoints() == 0) t.display.startStartup();
+    t.match.clear();
+    t.matchSnapshot.publish(t.match);
+    t.clock.start(millis());
+    if (t.game().totalPoints() != 0) t.clock.forget();  // Restored mid-game, or won
+    saveMatch(t);
+    publishGame(t);
+}
+
 void setup() {
+    unsigned long bootStart = millis();
+
     // Serial disabled — UART TX/RX pins may conflict with LED outputs
     // Use telnet (nc pingpong-scorer.local 23) for logging instead
     logger.println();
     logger.println("=== Ping Pong Scorer ===");
     logger.println("Initializing...");
 
-    // Initialize WiFi for OTA updates
+    // Stage 1: input, display and game go live immediately. Each strip
+    // gets its own RMT channel (the data pin is a template argument).
+    scheduler.begin();
+    memory.watch("game", scheduler.task());
+    table[0].display.begin<LED_DATA_PIN>();
+#if TABLE_COUNT > 1
+    table[1].display.begin<LED2_DATA_PIN>();
+#endif
+#if LED_ASYNC_SHOW
+    LedOutputTask::begin();
+    memory.watch("led", LedOutputTask::task());
+#endif
+    for (uint8_t i = 0; i < TABLE_COUNT; i++) setupTable(table[i], i);
+
+    // Stage 2: WiFi connects in the background; OTA and telnet are brought
+    // up by the network task once an IP is assigned (see startNetworkServices)
+    WiFi.onEvent(onWiFiEvent);
     WiFi.mode(WIFI_STA);
+    WiFi.setSleep(true);                // Modem sleep: required for idle light sleep
     WiFi.setHostname(OTA_HOSTNAME);
+#if MIRROR_STANDALONE
+    // No access point: the radio stays on one channel for the mirrors
+    esp_wifi_set_channel(MIRROR_CHANNEL > 0 ? MIRROR_CHANNEL : 1, WIFI_SECOND_CHAN_NONE);
+    logger.println("Standalone: no access point, mirror broadcast only");
+#else
+    WiFi.setAutoReconnect(true);
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    logger.print("Connecting to WiFi");
-
-    // Wait up to 10 seconds for WiFi — don't block forever
-    unsigned long wifiStart = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - wifiStart < 10000) {
-        delay(250);
-        logger.print(".");
-    }
-
-    if (WiFi.status() == WL_CONNECTED) {
-        logger.println();
-        logger.print("WiFi connected! IP: ");
-        logger.println(WiFi.localIP());
-
-        // Setup OTA
-        ArduinoOTA.setHostname(OTA_HOSTNAME);
-        #ifdef OTA_PASSWORD
-        ArduinoOTA.setPassword(OTA_PASSWORD);
-        #endif
-
-        ArduinoOTA.onStart([]() {
-            // Blank LEDs during OTA to reduce power draw / interference
-            FastLED.clear();
-            FastLED.show();
-            logger.println("OTA update starting...");
-        });
-        ArduinoOTA.onEnd([]() {
-            logger.println("\nOTA update complete! Rebooting...");
-        });
-        ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
-            logger.printf("OTA Progress: %u%%\r", (progress / (total / 100)));
-        });
-        ArduinoOTA.onError([](ota_error_t error) {
-            logger.printf("OTA Error[%u]: ", error);
-            if (error == OTA_AUTH_ERROR) logger.println("Auth Failed");
-            else if (error == OTA_BEGIN_ERROR) logger.println("Begin Failed");
-            else if (error == OTA_CONNECT_ERROR) logger.println("Connect Failed");
-            else if (error == OTA_RECEIVE_ERROR) logger.println("Receive Failed");
-            else if (error == OTA_END_ERROR) logger.println("End Failed");
-        });
-        ArduinoOTA.begin();
-        logger.begin();
-        logger.println("OTA ready. Telnet logging on port " + String(TELNET_PORT));
-    } else {
-        logger.println();
-        logger.println("WiFi failed — running without OTA. Game still works!");
-    }
-
-    // Initialize buttons
-    btn1.begin(BUTTON_PLAYER1_PIN);
-    btn2.begin(BUTTON_PLAYER2_PIN);
-
-    // Initialize display
-    display.begin();
-    display.animateStartup();
-
-    // Initialize game
-    game.reset();
-    printGameState();
-
-    logger.println("Ready! Press buttons to score.");
+    logger.println("Connecting to WiFi in the background...");
+#endif
+#if MIRROR_ENABLED
+    mirrors.begin();
+#endif
+
+    // Networking runs on the other core from here on
+    xTaskCreatePinnedToCore(networkTask, "net", NET_TASK_STACK, nullptr,
+                            NET_TASK_PRIORITY, &networkTaskHandle, NET_CORE);
+
+    logger.printf("Ready in %lu ms! %d table(s). Press buttons to score. Game loop on core %d\r\n",
+                  millis() - bootStart, TABLE_COUNT, xPortGetCoreID());
 }
 
 // =============================================================================
 // MAIN LOOP
 // =============================================================================
 
-void loop() {
-    // Handle OTA updates and telnet connections
-    ArduinoOTA.handle();
-    logger.handle();
+// Frame period one table needs right now (see FRAME SCHEDULING in config.h)
+uint16_t framePeriodMs(Table& t) {
+    const GameCore& game = t.game();
+    if (t.display.startupActive()) return FRAME_ANIM_MS;
+
+    // Keep tap / long-press resolution crisp while a button is in play
+    if (t.btn1.isHeld() || t.btn2.isHeld() || t.btn1.pendingPress || t.btn2.pendingPress) {
+        return FRAME_PLAYING_MS;
+    }
 
+    switch (game.state) {
+        case GameState::PLAYING:
+            return (game.totalPoints() == 0) ? FRAME_IDLE_MS : FRAME_PLAYING_MS;
+        case GameState::SERVE_CHANGE:
+            return FRAME_ANIM_MS;
+        case GameState::GAME_OVER:
+            return (millis() - game.animStartTime <= VICTORY_ANIM_MS) ? FRAME_ANIM_MS : FRAME_IDLE_MS;
+    }
+    return FRAME_PLAYING_MS;
+}
+
+// The busiest table sets the pace for all of them
+uint16_t framePeriodMs() {
+    if (otaActive) return FRAME_IDLE_MS;
+    uint16_t period = FRAME_IDLE_MS;
+    for (Table& t : table) {
+        uint16_t p = framePeriodMs(t);
+        if (p < period) period = p;
+    }
+    return period;
+}
+
+template <class Game>
+void runTable(Table& t, Game& game) {
     // Update button states
-    btn1.update();
-    btn2.update();
-
-    // Check for long-press reset (either button)
-    if (btn1.longPressed() || btn2.longPressed()) {
-        resetTriggered = true;
-        logger.println(">>> GAME RESET <<<");
-        game.reset();
-        display.clearAll();
-        display.show();
-        delay(200);
-        display.animateStartup();
-        printGameState();
+    {
+        PROFILE_SCOPE(BUTTON_1);
+        t.btn1.update();
     }
-    if (!btn1.isHeld() && !btn2.isHeld()) {
-        resetTriggered = false;
+    {
+        PROFILE_SCOPE(BUTTON_2);
+        t.btn2.update();
+    }
+
+    runGameCommands(t, game);
+    if (t.journal.rules() != Game::RuleType::id) return;   // Rules changed: next frame
+#if SPECULATIVE_TAPS
+    handleTaps(t, game);
+#endif
+
+    // Long press (either button) resets; both held at 0-0 switches rules
+    if (!t.resetTriggered && (t.btn1.longPressed() || t.btn2.longPressed())) {
+        t.resetTriggered = true;
+        if (t.btn1.isHeld() && t.btn2.isHeld() && game.totalPoints() == 0) {
+            switchRules(t, Game::RuleType::id == RuleSet::CLASSIC_21 ? RuleSet::ITTF_11
+                                                                     : RuleSet::CLASSIC_21);
+            return;
+        }
+        tlog(t).println(">>> GAME RESET <<<");
+        resetGame(t, game);
+    }
+    if (!t.btn1.isHeld() && !t.btn2.isHeld()) {
+        t.resetTriggered = false;
+    }
+
+    // Startup animation runs until done or a new tap interrupts it; the tap
+    // itself is then handled by the state machine as usual
+    if (t.display.startupActive()) {
+        if (t.btn1.pendingPress || t.btn1.doubleTapped || t.btn2.pendingPress || t.btn2.doubleTapped) {
+            t.display.cancelStartup();
+        } else {
+            t.display.animateStartup();
+            return;
+        }
     }
 
     // State machine
     switch (game.state) {
         case GameState::PLAYING:
-            handlePlaying();
+            handlePlaying(t, game);
             break;
 
         case GameState::SERVE_CHANGE:
-            handleServeChange();
+            handleServeChange(t, game);
             break;
 
         case GameState::GAME_OVER:
-            handleGameOver();
+            handleGameOver(t, game);
             break;
     }
+}
+
+void runFrame() {
+    // Every table renders into its own buffer; the changed strips then go
+    // out together in one FastLED.show()
+    LedFrame::beginFrame();
+    for (Table& t : table) {
+        // OTA in progress (network core): hold the score, pause the games
+        if (otaActive) {
+            t.display.renderFrozen(t.game());
+        } else {
+            withGame(t, [&](auto& game) { runTable(t, game); });
+        }
+    }
+    LedFrame::endFrame();
+}
+
+// Blank the strips and light-sleep until a button press, a telnet command
+// or OTA (see idlesleep.h)
+void sleepUntilPress() {
+    static ButtonState *buttons[2 * TABLE_COUNT];
+    for (uint8_t i = 0; i < TABLE_COUNT; i++) {
+        buttons[2 * i] = &table[i].btn1;
+        buttons[2 * i + 1] = &table[i].btn2;
+    }
+
+    logger.printf("Idle for %lu min: LEDs off, sleeping until a button press\r\n",
+                  (unsigned long)(IDLE_SLEEP_MS / 60000));
+    LedFrame::beginFrame();
+    for (Table& t : table) {
+        t.display.clearAll();
+        t.display.show();
+    }
+    LedFrame::endFrame();
+    LedFrame::waitIdle();
+
+    bool pressed = idleSleep.sleep(buttons, 2 * TABLE_COUNT, [] {
+        if (otaActive) return true;
+        for (Table& t : table) {
+            GameCommand c;
+            if (t.commands.peek(c)) return true;
+        }
+        return false;
+    });
+    if (!pressed) logger.println("Woke for network activity");
+
+    // Screens come back on the next frame (clearAll() dropped the layers)
+    scheduler.resync();
+}
+
+void loop() {
+    runFrame();
+    LATENCY_POLL();
+    for (Table& t : table) {
+        publishGame(t);
+        saveMatch(t);
+    }
+
+    // First frame after a button wake: report how long the wake took
+    if (idleSleep.takeWakeLatencyUs()) {
+        LedFrame::waitIdle();
+        logger.printf("Woke by button: first frame out %lu us after wake\r\n",
+                      (unsigned long)idleSleep.lastLatencyUs());
+    }
+
+    // Anything but a quiet idle frame postpones idle sleep
+    uint16_t period = framePeriodMs();
+    if (otaActive || period != FRAME_IDLE_MS) {
+        idleSleep.activity();
+    } else if (idleSleep.due()) {
+        sleepUntilPress();
+        return;
+    }
 
-    // Small delay to avoid hammering the LEDs
-    delay(16);  // ~60fps
+    // Sleep until the next frame deadline (or a button edge)
+    scheduler.wait(period);
+    scheduler.report(logger);
 }
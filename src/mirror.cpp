@@ -0,0 +1,123 @@
+// =============================================================================
+// PING PONG MIRROR DISPLAY
+// =============================================================================
+// Firmware for an extra score strip (env:esp32-mirror): same LED layout as
+// the primary, no buttons, no access point. It follows table MIRROR_TABLE
+// of a primary scorer over ESP-NOW broadcast (mirrorlink.h) and plays the
+// same serve-change and victory animations.
+//
+// Until the first packet arrives (or after MIRROR_LOST_MS of silence) it
+// steps through the WiFi channels looking for the primary; a lost or late
+// packet costs at most one keyframe interval (MIRROR_KEYFRAME_MS).
+// =============================================================================
+
+#ifdef PINGPONG_MIRROR
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <WiFi.h>
+#include "config.h"
+#include "game.h"
+#include "display.h"
+#include "ledtask.h"
+#include "mirror.h"
+#include "mirrorlink.h"
+#include "scheduler.h"
+
+// =============================================================================
+// GLOBALS
+// =============================================================================
+
+ScoreDisplay display;
+PingPongGame classic;               // One game per rule set; packets say which
+IttfGame ittf;
+RuleSet rules = RuleSet::CLASSIC_21;
+MirrorFollower follower(MIRROR_TABLE);
+MirrorReceiver radio;
+FrameScheduler scheduler;
+
+template <class Fn>
+void withGame(Fn&& fn) {
+    if (rules == RuleSet::ITTF_11) fn(ittf);
+    else fn(classic);
+}
+
+// =============================================================================
+// SETUP
+// =============================================================================
+
+void setup() {
+    scheduler.begin();
+    display.begin<LED_DATA_PIN>();
+#if LED_ASYNC_SHOW
+    LedOutputTask::begin();
+#endif
+    classic.renderOps = &display.renderQueue();
+    ittf.renderOps = &display.renderQueue();
+    classic.reset();
+    ittf.reset();
+    display.startStartup();         // Plays until the primary is heard
+
+    // Station mode, never connected: the radio only listens
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(false);           // Modem sleep would miss broadcasts
+    radio.begin(scheduler.task());
+}
+
+// =============================================================================
+// MAIN LOOP
+// =============================================================================
+
+// Apply everything received since the last frame
+void drainPackets() {
+    MirrorPacket p;
+    while (radio.pop(p)) {
+        if (p.table != MIRROR_TABLE) continue;
+        if (p.rules != (uint8_t)rules) rules = (RuleSet)p.rules;   // Then a resync
+        withGame([&](auto& g) {
+            if (follower.apply(p, g) != MirrorApply::IGNORED && display.startupActive()) {
+                display.cancelStartup();
+            }
+        });
+    }
+}
+
+// Same per-state rendering (and frame rate) as the primary's game loop
+template <class Game>
+uint16_t renderGame(Game& g) {
+    if (display.startupActive()) {
+        display.animateStartup();
+        return FRAME_ANIM_MS;
+    }
+    switch (g.state) {
+        case GameState::PLAYING:
+            if (g.totalPoints() == 0) {
+                display.renderIdle(g);
+                return FRAME_IDLE_MS;
+            }
+            display.renderPlaying(g);
+            return FRAME_PLAYING_MS;
+        case GameState::SERVE_CHANGE:
+            if (display.animateServeChange(g)) g.state = GameState::PLAYING;
+            return FRAME_ANIM_MS;
+        case GameState::GAME_OVER:
+            if (display.animateVictory(g)) display.renderGameOver(g);
+            return (millis() - g.animStartTime <= VICTORY_ANIM_MS) ? FRAME_ANIM_MS : FRAME_IDLE_MS;
+    }
+    return FRAME_PLAYING_MS;
+}
+
+void loop() {
+    drainPackets();
+    radio.service(follower.synced(), follower.silentMs());
+
+    uint16_t period = FRAME_PLAYING_MS;
+    LedFrame::beginFrame();
+    withGame([&](auto& g) { period = renderGame(g); });
+    LedFrame::endFrame();
+
+    // A packet notifies this task, so a point is drawn as soon as it lands
+    scheduler.wait(period);
+}
+
+#endif  // PINGPONG_MIRROR
@@ -0,0 +1,77 @@
+#pragma once
+
+// =============================================================================
+// Host (env:native) stand-in for the Arduino core
+// =============================================================================
+// Just enough of the API for the game and display headers. Time only moves
+// when a test says so: shimSetMillis() / shimAdvanceMillis(), or delay().
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define CHANGE          0x03
+#define FALLING         0x02
+
+#define IRAM_ATTR
+
+inline unsigned long g_shimMillis = 0;
+inline uint8_t g_shimPinLevel[64];
+
+inline void shimSetMillis(unsigned long ms) { g_shimMillis = ms; }
+inline void shimAdvanceMillis(unsigned long ms) { g_shimMillis += ms; }
+
+inline unsigned long millis() { return g_shimMillis; }
+inline unsigned long micros() { return g_shimMillis * 1000UL; }
+inline int64_t esp_timer_get_time() { return (int64_t)g_shimMillis * 1000; }
+inline void delay(unsigned long ms) { g_shimMillis += ms; }
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    if (mode == INPUT_PULLUP) g_shimPinLevel[pin] = HIGH;
+}
+inline int digitalRead(uint8_t pin) { return g_shimPinLevel[pin]; }
+inline void digitalWrite(uint8_t pin, uint8_t level) { g_shimPinLevel[pin] = level; }
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t size) {
+        for (size_t i = 0; i < size; i++) write(buf[i]);
+        return size;
+    }
+
+    size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(unsigned char v) { return printf("%u", (unsigned)v); }
+
+    size_t println() { return print("\r\n"); }
+    template <typename T>
+    size_t println(T v) { return print(v) + println(); }
+
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[256];
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        if (n < 0) return 0;
+        return write((const uint8_t *)buf, (size_t)n < sizeof(buf) ? n : sizeof(buf) - 1);
+    }
+};
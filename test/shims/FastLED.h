@@ -0,0 +1,161 @@
+#pragma once
+
+// =============================================================================
+// Host (env:native) stand-in for FastLED
+// =============================================================================
+// Pixel types and math follow FastLED's definitions (scale8, nscale8,
+// hsv2rgb_rainbow) so frame buffers match the device. Nothing is clocked
+// out: the FastLED object just counts show() calls.
+
+#include "Arduino.h"
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) {
+    return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+inline uint8_t scale8_video(uint8_t i, uint8_t scale) {
+    return (((uint16_t)i * scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+inline uint8_t sin8(uint8_t theta) {
+    return (uint8_t)lround((sin(theta * (2.0 * M_PI / 256.0)) + 1.0) * 127.5);
+}
+
+struct CRGB {
+    union {
+        struct { uint8_t r, g, b; };
+        uint8_t raw[3];
+    };
+
+    enum HTMLColorCode : uint32_t {
+        Black     = 0x000000,
+        Blue      = 0x0000FF,
+        Green     = 0x008000,
+        OrangeRed = 0xFF4500,
+        Red       = 0xFF0000,
+        White     = 0xFFFFFF,
+        Yellow    = 0xFFFF00,
+    };
+
+    CRGB() = default;
+    constexpr CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    constexpr CRGB(uint32_t code) : r((code >> 16) & 0xFF), g((code >> 8) & 0xFF), b(code & 0xFF) {}
+    constexpr CRGB(HTMLColorCode code) : CRGB((uint32_t)code) {}
+
+    CRGB& nscale8(uint8_t scale) {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+
+    uint32_t packed() const { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+
+    bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+    bool operator!=(const CRGB& o) const { return !(*this == o); }
+};
+
+inline void hsv2rgb_rainbow(uint8_t hue, uint8_t sat, uint8_t val, CRGB& rgb) {
+    uint8_t offset8 = (hue & 0x1F) << 3;
+    uint8_t third = scale8(offset8, 85);
+    uint8_t twothirds = scale8(offset8, 170);
+    uint8_t r, g, b;
+
+    if (!(hue & 0x80)) {
+        if (!(hue & 0x40)) {
+            if (!(hue & 0x20)) { r = 255 - third; g = third;      b = 0; }
+            else               { r = 171;         g = 85 + third; b = 0; }
+        } else {
+            if (!(hue & 0x20)) { r = 171 - twothirds; g = 170 + third; b = 0; }
+            else               { r = 0;               g = 255 - third; b = third; }
+        }
+    } else {
+        if (!(hue & 0x40)) {
+            if (!(hue & 0x20)) { r = 0;     g = 171 - twothirds; b = 85 + twothirds; }
+            else               { r = third; g = 0;               b = 255 - third; }
+        } else {
+            if (!(hue & 0x20)) { r = 85 + third;  g = 0; b = 171 - third; }
+            else               { r = 170 + third; g = 0; b = 85 - third; }
+        }
+    }
+
+    if (sat != 255) {
+        if (sat == 0) {
+            r = g = b = 255;
+        } else {
+            uint8_t desat = 255 - sat;
+            desat = scale8_video(desat, desat);
+            uint8_t satscale = 255 - desat;
+            r = scale8(r, satscale) + desat;
+            g = scale8(g, satscale) + desat;
+            b = scale8(b, satscale) + desat;
+        }
+    }
+
+    if (val != 255) {
+        val = scale8_video(val, val);
+        r = scale8_video(r, val);
+        g = scale8_video(g, val);
+        b = scale8_video(b, val);
+    }
+    rgb = CRGB(r, g, b);
+}
+
+struct CHSV {
+    uint8_t h, s, v;
+    CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+    operator CRGB() const {
+        CRGB rgb;
+        hsv2rgb_rainbow(h, s, v, rgb);
+        return rgb;
+    }
+};
+
+inline void fill_solid(CRGB *leds, int count, const CRGB& color) {
+    for (int i = 0; i < count; i++) leds[i] = color;
+}
+
+inline uint8_t beatsin8(uint8_t bpm, uint8_t lowest = 0, uint8_t highest = 255) {
+    uint8_t beat = (uint8_t)(((uint64_t)millis() * bpm * 280) >> 16);  // beat8()
+    return lowest + scale8(sin8(beat), highest - lowest);
+}
+
+enum EOrder { RGB = 0012, GRB = 0102 };
+enum LEDColorCorrection : uint32_t { TypicalLEDStrip = 0xFFB0F0 };
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2812B {};
+
+class CLEDController {
+public:
+    CLEDController& setCorrection(LEDColorCorrection) { return *this; }
+};
+
+class CFastLED {
+public:
+    template <template <uint8_t, EOrder> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+    CLEDController& addLeds(CRGB *leds, int count) {
+        this->leds = leds;
+        this->count = count;
+        return _controller;
+    }
+
+    void setBrightness(uint8_t scale) { _brightness = scale; }
+    uint8_t getBrightness() const { return _brightness; }
+    void show() { show(_brightness); }
+    void show(uint8_t scale) {
+        shows++;
+        lastScale = scale;
+    }
+    void clear() { if (leds) fill_solid(leds, count, CRGB::Black); }
+
+    CRGB *leds = nullptr;
+    int count = 0;
+    uint32_t shows = 0;
+    uint8_t lastScale = 0;
+
+private:
+    CLEDController _controller;
+    uint8_t _brightness = 255;
+};
+
+inline CFastLED FastLED;
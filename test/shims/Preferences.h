@@ -0,0 +1,44 @@
+#pragma once
+
+// =============================================================================
+// Host (env:native) stand-in for the ESP32 Preferences (NVS) library
+// =============================================================================
+// Keys live in memory for the life of the test process, so a fresh
+// Preferences object sees what an earlier one wrote, like NVS after a reboot.
+// g_shimNvsWrites counts putBytes() calls (i.e. flash commits).
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+inline std::map<std::string, std::vector<uint8_t>> g_shimNvs;
+inline uint32_t g_shimNvsWrites = 0;
+
+class Preferences {
+public:
+    bool begin(const char *name, [[maybe_unused]] bool readOnly = false) {
+        _ns = name;
+        return true;
+    }
+    void end() {}
+
+    size_t putBytes(const char *key, const void *value, size_t len) {
+        const uint8_t *p = static_cast<const uint8_t *>(value);
+        g_shimNvs[_ns + "/" + key].assign(p, p + len);
+        g_shimNvsWrites++;
+        return len;
+    }
+
+    size_t getBytes(const char *key, void *buf, size_t maxLen) {
+        auto it = g_shimNvs.find(_ns + "/" + key);
+        if (it == g_shimNvs.end() || it->second.size() > maxLen) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+
+    bool remove(const char *key) { return g_shimNvs.erase(_ns + "/" + key) > 0; }
+
+private:
+    std::string _ns;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+// =============================================================================
+// Host (env:native) stand-in for the ESP32 WiFi library (TCP only)
+// =============================================================================
+// Sockets are in-memory: a test queues a connection with shimConnect(), sets
+// how many bytes its send() will take with shimSocket(fd).budget, and reads
+// back what was sent from shimSocket(fd).sent. send() itself is in
+// lwip/sockets.h.
+
+#include <string>
+#include "Arduino.h"
+
+struct ShimSocket {
+    bool open = false;
+    std::string input;          // Bytes the peer sent, not yet read
+    std::string sent;           // Bytes the board sent
+    size_t budget = SIZE_MAX;   // send() takes this many more bytes, then EAGAIN
+};
+
+inline ShimSocket g_shimSockets[16];
+inline int g_shimPending = -1;  // Connection waiting in accept()
+
+inline ShimSocket& shimSocket(int fd) { return g_shimSockets[fd]; }
+
+// Queue a connection that will send `request`; returns its fd
+inline int shimConnect(const char *request) {
+    for (int fd = 0; fd < 16; fd++) {
+        if (g_shimSockets[fd].open) continue;
+        g_shimSockets[fd] = ShimSocket();
+        g_shimSockets[fd].open = true;
+        g_shimSockets[fd].input = request;
+        g_shimPending = fd;
+        return fd;
+    }
+    return -1;
+}
+
+class WiFiClient : public Print {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd) : _fd(fd) {}
+
+    int fd() const { return _fd; }
+    bool connected() const { return _fd >= 0 && g_shimSockets[_fd].open; }
+    void stop() {
+        if (_fd >= 0) g_shimSockets[_fd].open = false;
+        _fd = -1;
+    }
+    void setNoDelay(bool) {}
+
+    int available() const { return connected() ? (int)g_shimSockets[_fd].input.size() : 0; }
+    int read() {
+        if (available() == 0) return -1;
+        std::string& in = g_shimSockets[_fd].input;
+        int c = (uint8_t)in[0];
+        in.erase(0, 1);
+        return c;
+    }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buf, size_t size) override {
+        if (!connected()) return 0;
+        g_shimSockets[_fd].sent.append((const char *)buf, size);
+        return size;
+    }
+
+private:
+    int _fd = -1;
+};
+
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t) {}
+    void begin() {}
+    void setNoDelay(bool) {}
+    bool hasClient() const { return g_shimPending >= 0; }
+    WiFiClient available() {
+        WiFiClient c(g_shimPending);
+        g_shimPending = -1;
+        return c;
+    }
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+// =============================================================================
+// Host (env:native) stand-in for lwIP's BSD socket send() (see WiFi.h)
+// =============================================================================
+
+#include <errno.h>
+#include <sys/types.h>
+#include "WiFi.h"
+
+#define MSG_DONTWAIT 0x08
+
+inline ssize_t send(int fd, const void *buf, size_t len, int) {
+    if (fd < 0 || !g_shimSockets[fd].open) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    ShimSocket& s = g_shimSockets[fd];
+    if (s.budget == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    size_t n = (len < s.budget) ? len : s.budget;
+    s.sent.append((const char *)buf, n);
+    s.budget -= n;
+    return (ssize_t)n;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Placeholder credentials for the host build (include/secrets.h wins if present)
+
+#define WIFI_SSID           "native"
+#define WIFI_PASSWORD       "native"
+#define OTA_HOSTNAME        "pingpong-scorer"
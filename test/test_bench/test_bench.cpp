@@ -0,0 +1,100 @@
+// =============================================================================
+// Host microbenchmarks (pio test -e native -f test_bench -v)
+// =============================================================================
+// Reports ns/op for the rule and render hot paths. Numbers are for the host
+// CPU, so compare runs against each other rather than against the ESP32.
+
+#include <unity.h>
+#include <chrono>
+#include "display.h"
+
+static ScoreDisplay display;
+static PingPongGame game;
+static volatile uint32_t sink;
+
+void setUp() {
+    shimSetMillis(1000);
+    game.reset();
+    display.begin();
+}
+
+void tearDown() {}
+
+template <typename Fn>
+static double nsPerOp(uint32_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) fn(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+static void report(const char *name, double ns) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%-28s %10.1f ns/op", name, ns);
+    TEST_MESSAGE(msg);
+}
+
+static void bench_calculate_serving_player() {
+    // Sweep every reachable score, including deep deuce
+    double ns = nsPerOp(2000000, [](uint32_t i) {
+        game.score[0] = i % 31;
+        game.score[1] = (i / 31) % 31;
+        game.firstServer = (i / 961) & 1;
+        sink += game.calculateServingPlayer();
+    });
+    report("calculateServingPlayer()", ns);
+    TEST_ASSERT_TRUE(ns > 0);
+}
+
+static void bench_render_score() {
+    double ns = nsPerOp(200000, [](uint32_t i) {
+        game.setScore(i % 22, (i / 22) % 22);
+        display.renderScore(game);
+        sink += display.leds[1].r;
+    });
+    report("renderScore()", ns);
+    TEST_ASSERT_TRUE(ns > 0);
+}
+
+static void bench_render_playing_incremental() {
+    // One point per frame, patched through the render-op queue
+    game.renderOps = &display.renderQueue();
+    game.reset();
+    display.renderIdle(game);
+    double ns = nsPerOp(200000, [](uint32_t i) {
+        if (game.score[0] >= POINTS_TO_WIN - 2) {
+            game.reset();
+            display.renderIdle(game);
+        }
+        if (i & 1) game.removePoint(1);
+        else game.addPoint(0), game.addPoint(1);
+        game.state = GameState::PLAYING;
+        display.renderPlaying(game);
+        sink += display.leds[1].r;
+    });
+    game.renderOps = nullptr;
+    report("renderPlaying() incremental", ns);
+    TEST_ASSERT_TRUE(ns > 0);
+}
+
+static void bench_animate_victory() {
+    game.setScore(POINTS_TO_WIN, 12);
+    game.state = GameState::GAME_OVER;
+    game.animStartTime = millis();
+    double ns = nsPerOp(50000, [](uint32_t i) {
+        shimSetMillis(game.animStartTime + (i % (VICTORY_ANIM_MS / ANIMATION_SPEED_MS)) * ANIMATION_SPEED_MS);
+        display.animateVictory(game);
+        sink += display.leds[i % TOTAL_LEDS].g;
+    });
+    report("animateVictory()", ns);
+    TEST_ASSERT_TRUE(ns > 0);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(bench_calculate_serving_player);
+    RUN_TEST(bench_render_score);
+    RUN_TEST(bench_render_playing_incremental);
+    RUN_TEST(bench_animate_victory);
+    return UNITY_END();
+}
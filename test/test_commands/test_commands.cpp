@@ -0,0 +1,70 @@
+// =============================================================================
+// Telnet command parsing tests (pio test -e native -f test_commands)
+// =============================================================================
+
+#include <unity.h>
+#include "commands.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_tokenize_splits_in_place() {
+    char line[] = "  set 12   9 ";
+    Tokens t;
+    tokenize(line, t);
+    TEST_ASSERT_EQUAL(3, t.count);
+    TEST_ASSERT_EQUAL_STRING("set", t[0]);
+    TEST_ASSERT_EQUAL_STRING("12", t[1]);
+    TEST_ASSERT_EQUAL_STRING("9", t[2]);
+    TEST_ASSERT_EQUAL_STRING("", t[3]);
+    TEST_ASSERT_TRUE(t.word[0] >= line && t.word[0] < line + sizeof(line));  // No copies
+}
+
+static void test_tokenize_empty_and_overlong_lines() {
+    char blank[] = "    ";
+    Tokens t;
+    tokenize(blank, t);
+    TEST_ASSERT_EQUAL(0, t.count);
+    TEST_ASSERT_EQUAL_STRING("", t[0]);
+
+    // Words past CMD_MAX_TOKENS stay joined to the last one
+    char many[] = "a b c d e f";
+    tokenize(many, t);
+    TEST_ASSERT_EQUAL(CMD_MAX_TOKENS, t.count);
+    TEST_ASSERT_EQUAL_STRING("d e f", t[CMD_MAX_TOKENS - 1]);
+}
+
+static void test_parse_number_bounds() {
+    uint16_t v = 0;
+    TEST_ASSERT_TRUE(parseNumber("0", 99, v));
+    TEST_ASSERT_EQUAL(0, v);
+    TEST_ASSERT_TRUE(parseNumber("99", 99, v));
+    TEST_ASSERT_EQUAL(99, v);
+    TEST_ASSERT_FALSE(parseNumber("100", 99, v));
+    TEST_ASSERT_FALSE(parseNumber("99999999999", 99, v));
+    TEST_ASSERT_FALSE(parseNumber("-1", 99, v));
+    TEST_ASSERT_FALSE(parseNumber("1x", 99, v));
+    TEST_ASSERT_FALSE(parseNumber("", 99, v));
+}
+
+static void test_command_queue_drops_when_full() {
+    static GameCommandQueue q;
+    for (int i = 0; i < CMD_QUEUE_SIZE - 1; i++) {
+        TEST_ASSERT_TRUE(q.push({GameCommandType::UNDO, 0, 0}));
+    }
+    TEST_ASSERT_FALSE(q.push({GameCommandType::RESET, 0, 0}));
+    TEST_ASSERT_EQUAL(1, q.dropped());
+
+    GameCommand c;
+    TEST_ASSERT_TRUE(q.peek(c));
+    TEST_ASSERT_TRUE(c.type == GameCommandType::UNDO);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_tokenize_splits_in_place);
+    RUN_TEST(test_tokenize_empty_and_overlong_lines);
+    RUN_TEST(test_parse_number_bounds);
+    RUN_TEST(test_command_queue_drops_when_full);
+    return UNITY_END();
+}
@@ -0,0 +1,402 @@
+// =============================================================================
+// ScoreDisplay golden-frame tests (pio test -e native -f test_display)
+// =============================================================================
+// Each golden lists the lit pixels of a frame; every other pixel must be
+// BG_COLOR. Regenerate by hand if the layout or colors in config.h change.
+
+#include <unity.h>
+#include "display.h"
+
+struct GoldenPixel {
+    uint8_t index;
+    uint32_t rgb;
+};
+
+static const GoldenPixel GOLDEN_7_3[] = {
+    {  1, 0x0000FF}, {  3, 0x0000FF}, {  5, 0x0000FF}, {  7, 0x0000FF},
+    {  9, 0x0000FF}, { 11, 0x008000}, { 13, 0x008000}, {139, 0x0000FF},
+    {141, 0x0000FF}, {143, 0x0000FF},
+};
+
+// Deuce, P1 advantage: red advantage LED just past P1's serve indicator
+static const GoldenPixel GOLDEN_21_20[] = {
+    {  1, 0x0000FF}, {  3, 0x0000FF}, {  5, 0x0000FF}, {  7, 0x0000FF},
+    {  9, 0x0000FF}, { 11, 0x008000}, { 13, 0x008000}, { 15, 0x008000},
+    { 17, 0x008000}, { 19, 0x008000}, { 21, 0xFFFF00}, { 23, 0xFFFF00},
+    { 25, 0xFFFF00}, { 27, 0xFFFF00}, { 29, 0xFFFF00}, { 31, 0xFF4500},
+    { 33, 0xFF4500}, { 35, 0xFF4500}, { 37, 0xFF4500}, { 39, 0xFF4500},
+    { 41, 0xFF0000}, { 44, 0xFF0000}, {105, 0xFF4500}, {107, 0xFF4500},
+    {109, 0xFF4500}, {111, 0xFF4500}, {113, 0xFF4500}, {115, 0xFFFF00},
+    {117, 0xFFFF00}, {119, 0xFFFF00}, {121, 0xFFFF00}, {123, 0xFFFF00},
+    {125, 0x008000}, {127, 0x008000}, {129, 0x008000}, {131, 0x008000},
+    {133, 0x008000}, {135, 0x0000FF}, {137, 0x0000FF}, {139, 0x0000FF},
+    {141, 0x0000FF}, {143, 0x0000FF},
+};
+
+// Final score 21-15: loser's side dimmed to LOSER_DIM
+static const GoldenPixel GOLDEN_GAME_OVER_21_15[] = {
+    {  1, 0x0000FF}, {  3, 0x0000FF}, {  5, 0x0000FF}, {  7, 0x0000FF},
+    {  9, 0x0000FF}, { 11, 0x008000}, { 13, 0x008000}, { 15, 0x008000},
+    { 17, 0x008000}, { 19, 0x008000}, { 21, 0xFFFF00}, { 23, 0xFFFF00},
+    { 25, 0xFFFF00}, { 27, 0xFFFF00}, { 29, 0xFFFF00}, { 31, 0xFF4500},
+    { 33, 0xFF4500}, { 35, 0xFF4500}, { 37, 0xFF4500}, { 39, 0xFF4500},
+    { 41, 0xFF0000}, {115, 0x141400}, {117, 0x141400}, {119, 0x141400},
+    {121, 0x141400}, {123, 0x141400}, {125, 0x000A00}, {127, 0x000A00},
+    {129, 0x000A00}, {131, 0x000A00}, {133, 0x000A00}, {135, 0x000014},
+    {137, 0x000014}, {139, 0x000014}, {141, 0x000014}, {143, 0x000014},
+};
+
+static ScoreDisplay display;
+static PingPongGame game;
+
+void setUp() {
+    shimSetMillis(1000);
+    game.renderOps = nullptr;
+    game.reset();
+    display.begin();
+}
+
+void tearDown() {}
+
+static void setScore(uint8_t p1, uint8_t p2) {
+    game.setScore(p1, p2);
+}
+
+static void assertFrame(const GoldenPixel *golden, size_t count) {
+    CRGB expected[TOTAL_LEDS];
+    fill_solid(expected, TOTAL_LEDS, BG_COLOR);
+    for (size_t i = 0; i < count; i++) expected[golden[i].index] = CRGB(golden[i].rgb);
+
+    for (int i = 0; i < TOTAL_LEDS; i++) {
+        char msg[48];
+        snprintf(msg, sizeof(msg), "pixel %d", i);
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(expected[i].packed(), display.leds[i].packed(), msg);
+    }
+}
+
+#define ASSERT_FRAME(golden) assertFrame(golden, sizeof(golden) / sizeof(golden[0]))
+
+static void test_render_score_golden() {
+    setScore(7, 3);
+    display.clearAll();
+    display.renderScore(game);
+    ASSERT_FRAME(GOLDEN_7_3);
+}
+
+static void test_render_deuce_advantage_golden() {
+    setScore(21, 20);
+    display.clearAll();
+    display.renderScore(game);
+    ASSERT_FRAME(GOLDEN_21_20);
+}
+
+static void test_render_game_over_golden() {
+    setScore(21, 15);
+    game.state = GameState::GAME_OVER;
+    display.renderGameOver(game);
+    ASSERT_FRAME(GOLDEN_GAME_OVER_21_15);
+}
+
+static void test_serve_indicator_on_servers_side() {
+    const int p1ServeIdx = P1_LED_OFFSET + SCORE_LEDS_PER_SIDE;
+    const int p2ServeIdx = TOTAL_LEDS - SCORE_LEDS_PER_SIDE - 1;
+
+    setScore(0, 0);
+    display.renderIdle(game);
+    TEST_ASSERT_TRUE(display.leds[p1ServeIdx] != BG_COLOR);
+    TEST_ASSERT_TRUE(display.leds[p2ServeIdx] == BG_COLOR);
+
+    setScore(3, 2);
+    display.renderPlaying(game);
+    TEST_ASSERT_TRUE(display.leds[p1ServeIdx] == BG_COLOR);
+    TEST_ASSERT_TRUE(display.leds[p2ServeIdx] != BG_COLOR);
+}
+
+static void test_unchanged_frames_are_not_sent() {
+    setScore(7, 3);
+    display.renderPlaying(game);
+    uint32_t shows = FastLED.shows;
+
+    // Same score, same pulse phase: nothing to send
+    for (int i = 0; i < 10; i++) display.renderPlaying(game);
+    TEST_ASSERT_EQUAL(shows, FastLED.shows);
+
+    // Pulse moves: one frame
+    shimAdvanceMillis(400);
+    display.renderPlaying(game);
+    TEST_ASSERT_EQUAL(shows + 1, FastLED.shows);
+
+    // Score changes: one frame
+    setScore(8, 3);
+    display.renderPlaying(game);
+    TEST_ASSERT_EQUAL(shows + 2, FastLED.shows);
+}
+
+static void test_game_over_frame_sent_once() {
+    setScore(21, 15);
+    game.state = GameState::GAME_OVER;
+    uint32_t shows = FastLED.shows;
+    for (int i = 0; i < 10; i++) {
+        shimAdvanceMillis(50);
+        display.renderGameOver(game);
+    }
+    TEST_ASSERT_EQUAL(shows + 1, FastLED.shows);
+}
+
+// OTA freeze: the score with a steady serve LED, sent once however long
+// the update takes
+static void test_frozen_frame_holds_score() {
+    setScore(7, 3);
+    display.renderPlaying(game);
+    uint32_t shows = FastLED.shows;
+    for (int i = 0; i < 10; i++) {
+        shimAdvanceMillis(50);
+        display.renderFrozen(game);
+    }
+    TEST_ASSERT_EQUAL(shows + 1, FastLED.shows);
+    TEST_ASSERT_TRUE(display.leds[tables::SERVE_PIXEL[game.servingPlayer]] == SERVE_COLOR);
+    TEST_ASSERT_TRUE(display.leds[tables::SCORE_PIXEL.index[0][6]] != BG_COLOR);
+}
+
+// Two tables: both strips change in a frame, one FastLED.show() sends them
+static void test_led_frame_batches_strips() {
+    static ScoreDisplay second;
+    second.begin<LED_DATA_PIN + 1>();
+    PingPongGame other;
+    other.reset();
+    setScore(7, 3);
+    uint32_t shows = FastLED.shows;
+
+    LedFrame::beginFrame();
+    display.renderPlaying(game);
+    second.renderPlaying(other);
+    TEST_ASSERT_EQUAL(shows, FastLED.shows);
+    LedFrame::endFrame();
+    TEST_ASSERT_EQUAL(shows + 1, FastLED.shows);
+
+    // Nothing changed: an empty frame sends nothing
+    LedFrame::beginFrame();
+    display.renderPlaying(game);
+    second.renderPlaying(other);
+    LedFrame::endFrame();
+    TEST_ASSERT_EQUAL(shows + 1, FastLED.shows);
+}
+
+// The running channel sum follows partial updates exactly
+static void test_power_load_tracks_dirty_pixels() {
+    uint32_t base = LedFrame::load();
+
+    display.leds[10] = CRGB(255, 0, 0);
+    display.markDirty(10);
+    display.leds[90] = CRGB(0, 100, 50);
+    display.markDirty(90);
+    display.show();
+    TEST_ASSERT_EQUAL(base + 255 + 150, LedFrame::load());
+
+    display.leds[10] = BG_COLOR;
+    display.markDirty(10);
+    display.show();
+    TEST_ASSERT_EQUAL(base + 150, LedFrame::load());
+}
+
+// Full white at full brightness exceeds the budget: sent dimmer, pixels untouched
+static void test_power_budget_scales_brightness() {
+    FastLED.setBrightness(255);
+    fill_solid(display.leds, TOTAL_LEDS, CRGB::White);
+    display.markAllDirty();
+    display.show();
+    TEST_ASSERT_TRUE(LedFrame::estimateMa(255) > POWER_BUDGET_MA);
+    TEST_ASSERT_TRUE(FastLED.lastScale < 255);
+    TEST_ASSERT_TRUE(LedFrame::lastMa() <= POWER_BUDGET_MA);
+    TEST_ASSERT_TRUE(LedFrame::lastMa() > POWER_BUDGET_MA - 50);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFF, display.leds[0].packed());
+
+    // Normal play is under budget: full brightness
+    display.clearAll();
+    display.show();
+    TEST_ASSERT_EQUAL(255, FastLED.lastScale);
+    FastLED.setBrightness(BRIGHTNESS);
+}
+
+// Async output: frames go to the output hook, and the front buffer is only
+// written after waiting for the previous frame
+static uint32_t g_transmits, g_waits;
+static bool g_inFlight;
+
+static void fakeTransmit(uint8_t) {
+    g_transmits++;
+    g_inFlight = true;
+}
+
+static void fakeWaitIdle() {
+    g_waits++;
+    g_inFlight = false;
+}
+
+static void test_async_output_waits_before_front_buffer_write() {
+    g_transmits = g_waits = 0;
+    g_inFlight = false;
+    LedFrame::setOutput(fakeTransmit, fakeWaitIdle);
+    uint32_t shows = FastLED.shows;
+
+    setScore(3, 1);
+    display.renderPlaying(game);
+    TEST_ASSERT_EQUAL(1, g_transmits);
+    TEST_ASSERT_TRUE(g_inFlight);
+
+    setScore(4, 1);
+    display.renderPlaying(game);
+    TEST_ASSERT_EQUAL(2, g_transmits);
+    TEST_ASSERT_TRUE(g_waits >= 1);      // Waited out frame 1 before copying frame 2
+    TEST_ASSERT_EQUAL(shows, FastLED.shows);
+
+    LedFrame::setOutput(nullptr, nullptr);
+}
+
+static void test_victory_ring_matches_hsv_rainbow() {
+    setScore(21, 7);
+    game.state = GameState::GAME_OVER;
+    game.animStartTime = millis();
+
+    // Sample frames with the winner flash both on and off
+    for (int frame = 0; frame < 64; frame += 3) {
+        shimSetMillis(game.animStartTime + frame * ANIMATION_SPEED_MS);
+        display.animateVictory(game);
+        bool flashing = (frame / 5) % 2 == 0;
+        for (int i = 0; i < TOTAL_LEDS; i++) {
+            CRGB expected = CHSV(i * VICTORY_HUE_PER_LED + frame * VICTORY_HUE_PER_FRAME,
+                                 255, VICTORY_RAINBOW_VAL);
+            for (int pt = 0; flashing && pt < game.score[0]; pt++) {
+                if (tables::SCORE_PIXEL.index[0][pt] == i) expected = VICTORY_FLASH_COLOR;
+            }
+            TEST_ASSERT_EQUAL_HEX32(expected.packed(), display.leds[i].packed());
+        }
+    }
+}
+
+// Serve change comet: placed by elapsed time however late the frame, drawn
+// over the score, and the only pixels that differ from the score layer
+static void test_serve_sweep_layers_over_score() {
+    static ScoreDisplay reference;
+    setScore(SERVE_SWITCH_EVERY, 0);
+    game.state = GameState::SERVE_CHANGE;
+    game.animStartTime = millis();
+    reference.clearAll();
+    reference.renderScore(game);
+
+    uint16_t from = tables::SERVE_PIXEL[1 - game.servingPlayer];
+    uint16_t to = tables::SERVE_PIXEL[game.servingPlayer];
+    uint32_t half = (SERVE_SWEEP_MS - ANIMATION_SPEED_MS) / 2;
+    uint16_t pos = EffectEngine::sample(fx::SERVE_SWEEP.position, half, 0);
+    int head = from + ((int)to - (int)from) * pos / 65535;
+    int dir = (from < to) ? -1 : 1;
+
+    shimSetMillis(game.animStartTime + 10);
+    TEST_ASSERT_FALSE(display.animateServeChange(game));
+    shimSetMillis(game.animStartTime + half);      // Skipped every frame between
+    TEST_ASSERT_FALSE(display.animateServeChange(game));
+    TEST_ASSERT_EQUAL_HEX32(CRGB(SERVE_ANIM_COLOR).packed(), display.leds[head].packed());
+    for (int i = 0; i < TOTAL_LEDS; i++) {
+        int k = (i - head) * dir;
+        if (k >= 0 && k < 10) continue;             // Comet and its trail
+        TEST_ASSERT_EQUAL_HEX32(reference.leds[i].packed(), display.leds[i].packed());
+    }
+
+    // Done: the score layer is back as it was
+    shimSetMillis(game.animStartTime + SERVE_SWEEP_MS);
+    TEST_ASSERT_TRUE(display.animateServeChange(game));
+    for (int i = 0; i < TOTAL_LEDS; i++) {
+        TEST_ASSERT_EQUAL_HEX32(reference.leds[i].packed(), display.leds[i].packed());
+    }
+}
+
+// Frame a from-scratch redraw of the current game would produce
+static void assertMatchesFullRedraw([[maybe_unused]] const char *step) {
+    static ScoreDisplay reference;
+    PingPongGame copy = game;
+    copy.renderOps = nullptr;
+    reference.clearAll();
+    if (copy.totalPoints() == 0) reference.renderIdle(copy);
+    else reference.renderPlaying(copy);
+    for (int i = 0; i < TOTAL_LEDS; i++) {
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(reference.leds[i].packed(), display.leds[i].packed(), step);
+    }
+}
+
+static void renderFrame() {
+    if (game.totalPoints() == 0) display.renderIdle(game);
+    else display.renderPlaying(game);
+}
+
+static void test_render_ops_match_full_redraw() {
+    game.renderOps = &display.renderQueue();
+    game.reset();
+    renderFrame();
+
+    // Swap server at 0-0, then play into deuce with undos along the way;
+    // serve-change animations are skipped so every point is patched
+    game.swapFirstServer();
+    renderFrame();
+    assertMatchesFullRedraw("swap");
+
+    const uint8_t script[] = {0, 1, 0, 0, 1, 1, 0, 1, 0, 1};
+    char step[32];
+    for (int round = 0; round < 5; round++) {
+        for (uint8_t i = 0; i < sizeof(script); i++) {
+            game.addPoint(script[i]);
+            game.state = GameState::PLAYING;
+            renderFrame();
+            snprintf(step, sizeof(step), "add %u-%u", game.score[0], game.score[1]);
+            assertMatchesFullRedraw(step);
+        }
+        game.removePoint(round & 1);
+        renderFrame();
+        snprintf(step, sizeof(step), "undo %u-%u", game.score[0], game.score[1]);
+        assertMatchesFullRedraw(step);
+    }
+    TEST_ASSERT_TRUE(game.isDeuce());
+
+    // Back down to 0-0 through advantage changes
+    while (game.totalPoints() > 0) {
+        game.removePoint(game.score[0] >= game.score[1] ? 0 : 1);
+        renderFrame();
+        snprintf(step, sizeof(step), "down %u-%u", game.score[0], game.score[1]);
+        assertMatchesFullRedraw(step);
+    }
+}
+
+static void test_render_op_overflow_falls_back_to_redraw() {
+    game.renderOps = &display.renderQueue();
+    game.reset();
+    renderFrame();
+
+    // More changes than the queue holds between two frames
+    for (int i = 0; i < RENDER_QUEUE_SIZE + 4; i++) {
+        game.addPoint(i & 1);
+        game.state = GameState::PLAYING;
+    }
+    TEST_ASSERT_TRUE(display.renderQueue().overflowed());
+    renderFrame();
+    assertMatchesFullRedraw("overflow");
+    TEST_ASSERT_FALSE(display.renderQueue().overflowed());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_render_score_golden);
+    RUN_TEST(test_render_deuce_advantage_golden);
+    RUN_TEST(test_render_game_over_golden);
+    RUN_TEST(test_serve_indicator_on_servers_side);
+    RUN_TEST(test_unchanged_frames_are_not_sent);
+    RUN_TEST(test_game_over_frame_sent_once);
+    RUN_TEST(test_frozen_frame_holds_score);
+    RUN_TEST(test_led_frame_batches_strips);
+    RUN_TEST(test_power_load_tracks_dirty_pixels);
+    RUN_TEST(test_power_budget_scales_brightness);
+    RUN_TEST(test_async_output_waits_before_front_buffer_write);
+    RUN_TEST(test_victory_ring_matches_hsv_rainbow);
+    RUN_TEST(test_serve_sweep_layers_over_score);
+    RUN_TEST(test_render_ops_match_full_redraw);
+    RUN_TEST(test_render_op_overflow_falls_back_to_redraw);
+    return UNITY_END();
+}
@@ -0,0 +1,265 @@
+// =============================================================================
+// Randomized rule + render harness (pio test -e native -f test_fuzz -v)
+// =============================================================================
+// Drives each rule set through a seeded random walk of points, undos (in
+// place with removePoint(), and through the journal with replay()), 0-0
+// server swaps, resets and new games. After every event it checks:
+//   - score and serve against a plain model of the rules in config.h
+//     (rotation every serveSwitchEvery, every deuceServeSwitch at deuce,
+//     trailing player at game point / advantage), win by winBy
+//   - a journal replay rebuilds the same game
+//   - the incrementally patched frame (render ops) hashes the same as a
+//     full redraw of the same game on a second display
+// and reports events/s plus a digest of every frame. The digest depends
+// only on the seed, so a change to the rule or render code that should not
+// change behaviour must leave it alone; compare events/s across builds.
+//
+// FUZZ_EVENTS (per rule set) and FUZZ_SEED can be set with -D.
+
+#include <unity.h>
+#include <chrono>
+#include "display.h"
+#include "journal.h"
+
+#ifndef FUZZ_EVENTS
+#define FUZZ_EVENTS 1000000UL
+#endif
+
+#ifndef FUZZ_SEED
+#define FUZZ_SEED 0x5EEDF00DUL
+#endif
+
+static ScoreDisplay live;   // Patched from render ops, as on the board
+static ScoreDisplay ref;    // Redrawn from scratch every step
+static PointJournal journal;
+static RunHistory runs;     // Beside the journal, for exact in-place undo
+static PingPongGame classic, classicReplay;
+static IttfGame ittf, ittfReplay;
+
+void setUp() {
+    shimSetMillis(1000);
+    live.begin();
+    ref.begin();
+}
+
+void tearDown() {}
+
+static uint32_t rngState;
+
+static uint32_t rng() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static uint32_t frameHash(const CRGB *leds, uint32_t h = 2166136261u) {
+    const uint8_t *p = (const uint8_t *)leds;
+    for (size_t i = 0; i < sizeof(CRGB) * TOTAL_LEDS; i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// Event mix, in 1/256ths
+enum class FuzzEvent : uint8_t { POINT, UNDO_IN_PLACE, UNDO_REPLAY, SWAP, RESET };
+
+static FuzzEvent pickEvent(bool gameOver) {
+    uint8_t r = rng() & 0xFF;
+    if (gameOver) {
+        if (r < 64) return FuzzEvent::UNDO_IN_PLACE;
+        if (r < 96) return FuzzEvent::UNDO_REPLAY;
+        if (r < 104) return FuzzEvent::POINT;    // Must be ignored
+        return FuzzEvent::RESET;                 // Next game
+    }
+    if (r < 208) return FuzzEvent::POINT;
+    if (r < 226) return FuzzEvent::UNDO_IN_PLACE;
+    if (r < 240) return FuzzEvent::UNDO_REPLAY;
+    if (r < 252) return FuzzEvent::SWAP;
+    return FuzzEvent::RESET;
+}
+
+// Who serves at (p1, p2), straight from the rules as written
+template <class Rules>
+static uint8_t modelServer(uint8_t p1, uint8_t p2, uint8_t first) {
+    uint16_t total = p1 + p2;
+    uint8_t hi = p1 > p2 ? p1 : p2;
+    if (p1 >= Rules::deuceThreshold && p2 >= Rules::deuceThreshold) {
+        if (Rules::trailingServes && p1 != p2) return p1 > p2 ? 1 : 0;
+        uint16_t before = 2 * Rules::deuceThreshold;
+        return (first + before / Rules::serveSwitchEvery + (total - before) / Rules::deuceServeSwitch) & 1;
+    }
+    if (Rules::trailingServes && hi >= Rules::pointsToWin - 1) return p1 > p2 ? 1 : 0;
+    return (first + total / Rules::serveSwitchEvery) & 1;
+}
+
+template <class Rules>
+static int8_t modelWinner(uint8_t p1, uint8_t p2) {
+    for (uint8_t p = 0; p < 2; p++) {
+        uint8_t mine = p ? p2 : p1;
+        uint8_t theirs = p ? p1 : p2;
+        if (mine >= Rules::pointsToWin &&
+            (theirs < Rules::deuceThreshold || mine - theirs >= Rules::winBy)) return p;
+    }
+    return -1;
+}
+
+// Replay only sees points still in the journal window: stats match the
+// live game unless points of this game have been folded into the base
+static bool windowCoversGame() {
+    static JournalImage img;
+    journal.save(img);
+    if (img.baseScore[0] == 0 && img.baseScore[1] == 0) return true;
+    for (uint16_t i = 0; i < img.count; i++) {
+        if (PointJournal::type(img.records[i]) == JournalEvent::RESET) return true;
+    }
+    return false;
+}
+
+// One failed check: say where, so the run can be repeated with this seed
+#define FUZZ_CHECK(cond, what)                                                          \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            char msg[128];                                                              \
+            snprintf(msg, sizeof(msg), "%s: event %lu, seed 0x%08lX, score %u-%u", what, \
+                     (unsigned long)n, (unsigned long)FUZZ_SEED, game.score[0], game.score[1]); \
+            TEST_FAIL_MESSAGE(msg);                                                     \
+        }                                                                               \
+    } while (0)
+
+template <class Game>
+static void fuzz(Game& game, Game& replayed, const char *name) {
+    typedef typename Game::RuleType Rules;
+    rngState = FUZZ_SEED;
+    shimSetMillis(1000);
+    journal.startRules(Rules::id, 0);
+    game.renderOps = &live.renderQueue();
+    game.runHistory = &runs;
+    game.reset();
+    live.clearAll();
+
+    uint32_t digest = 2166136261u;
+    uint32_t replays = 0;
+    uint32_t games = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t n = 0; n < FUZZ_EVENTS; n++) {
+        shimAdvanceMillis(1 + (rng() & 0xFF));
+        bool wasOver = (game.state == GameState::GAME_OVER);
+        uint8_t before[2] = {game.score[0], game.score[1]};
+        bool editedJournal = false;
+
+        switch (pickEvent(wasOver)) {
+            case FuzzEvent::POINT: {
+                uint8_t p = rng() & 1;
+                game.addPoint(p);
+                if (wasOver) {
+                    FUZZ_CHECK(game.score[0] == before[0] && game.score[1] == before[1],
+                               "point scored after game over");
+                    break;
+                }
+                journal.recordPoint(p);
+                if (game.state == GameState::SERVE_CHANGE) game.state = GameState::PLAYING;
+                break;
+            }
+            case FuzzEvent::UNDO_IN_PLACE: {
+                // Last event must be a point of the current game
+                uint16_t count = journal.size();
+                if (count == 0) break;
+                JournalEvent e = PointJournal::type(journal.raw(count - 1));
+                if (e != JournalEvent::POINT_P1 && e != JournalEvent::POINT_P2) break;
+                uint8_t p = (e == JournalEvent::POINT_P1) ? 0 : 1;
+                game.removePoint(p);
+                journal.undo();
+                FUZZ_CHECK(game.state == GameState::PLAYING && !game.isGameWon(),
+                           "removePoint left the game over");
+                FUZZ_CHECK(game.score[p] == before[p] - 1, "removePoint score");
+                break;
+            }
+            case FuzzEvent::UNDO_REPLAY:
+                if (journal.undo()) {
+                    journal.replay(game);
+                    if (game.isGameWon()) game.state = GameState::GAME_OVER;
+                    editedJournal = true;
+                }
+                break;
+            case FuzzEvent::SWAP:
+                if (game.totalPoints() == 0) {
+                    game.swapFirstServer();
+                    journal.recordSwap();
+                }
+                break;
+            case FuzzEvent::RESET:
+                if (wasOver) {
+                    // New game, loser serves first (handleGameOver)
+                    uint8_t loser = 1 - game.winner();
+                    game.reset();
+                    game.firstServer = loser;
+                    game.servingPlayer = loser;
+                    journal.startGame(loser);
+                    games++;
+                } else {
+                    game.reset();
+                    journal.recordReset();
+                }
+                break;
+        }
+
+        // Rules
+        int8_t w = modelWinner<Rules>(game.score[0], game.score[1]);
+        FUZZ_CHECK(game.winner() == w, "winner");
+        FUZZ_CHECK((game.state == GameState::GAME_OVER) == (w >= 0), "game over state");
+        if (w >= 0 && game.score[1 - w] >= Rules::deuceThreshold) {
+            FUZZ_CHECK(game.score[w] - game.score[1 - w] == Rules::winBy, "win margin");
+        }
+        FUZZ_CHECK(game.servingPlayer == modelServer<Rules>(game.score[0], game.score[1], game.firstServer),
+                   "server");
+        FUZZ_CHECK(game.isDeuce() == (game.score[0] >= Rules::deuceThreshold &&
+                                      game.score[1] >= Rules::deuceThreshold), "deuce");
+
+        // Replay (every edit through the journal, and every 64th event)
+        if (editedJournal || (n & 63) == 0) {
+            journal.replay(replayed);
+            replays++;
+            FUZZ_CHECK(replayed.score[0] == game.score[0] && replayed.score[1] == game.score[1] &&
+                       replayed.firstServer == game.firstServer &&
+                       replayed.servingPlayer == game.servingPlayer &&
+                       replayed.winner() == game.winner(), "replay");
+            // Every stats field, however it was undone
+            FUZZ_CHECK(!windowCoversGame() ||
+                       memcmp(&replayed.stats, &game.stats, sizeof(GameStats)) == 0, "replay stats");
+        }
+
+        // Frame: incremental vs. full redraw
+        ref.clearAll();
+        if (game.state == GameState::GAME_OVER) {
+            live.renderGameOver(game);
+            ref.renderGameOver(game);
+        } else {
+            live.renderPlaying(game);
+            ref.renderScore(game);
+            ref.renderServeIndicator(game);
+        }
+        uint32_t h = frameHash(live.leds);
+        FUZZ_CHECK(h == frameHash(ref.leds), "frame differs from full redraw");
+        digest = frameHash(live.leds, digest ^ h);
+    }
+
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    game.renderOps = nullptr;
+    game.runHistory = nullptr;
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%-18s %10.0f events/s  (%lu events, %lu games, %lu replays, digest %08lX)",
+             name, FUZZ_EVENTS / s, (unsigned long)FUZZ_EVENTS, (unsigned long)games,
+             (unsigned long)replays, (unsigned long)digest);
+    TEST_MESSAGE(msg);
+}
+
+static void fuzz_classic() { fuzz(classic, classicReplay, Classic21::name); }
+static void fuzz_ittf() { fuzz(ittf, ittfReplay, Ittf11::name); }
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(fuzz_classic);
+    RUN_TEST(fuzz_ittf);
+    return UNITY_END();
+}
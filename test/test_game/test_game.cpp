@@ -0,0 +1,297 @@
+// =============================================================================
+// PingPongGame rule tests (pio test -e native -f test_game)
+// =============================================================================
+
+#include <unity.h>
+#include "game.h"
+
+static PingPongGame game;
+
+void setUp() {
+    shimSetMillis(1000);
+    game.reset();
+}
+
+void tearDown() {}
+
+// Put the game at a given score with serve recomputed, as if played out
+static void setScore(uint8_t p1, uint8_t p2) {
+    game.setScore(p1, p2);
+    game.state = GameState::PLAYING;
+}
+
+static void test_reset_starts_at_love_with_p1_serving() {
+    TEST_ASSERT_EQUAL(0, game.score[0]);
+    TEST_ASSERT_EQUAL(0, game.score[1]);
+    TEST_ASSERT_EQUAL(0, game.servingPlayer);
+    TEST_ASSERT_TRUE(game.state == GameState::PLAYING);
+}
+
+static void test_serve_rotates_every_serve_switch_points() {
+    for (uint8_t first = 0; first < 2; first++) {
+        game.reset();
+        game.firstServer = first;
+        // Stay below game point: alternate points up to 19-19
+        for (uint8_t total = 0; total < 2 * (DEUCE_THRESHOLD - 1); total++) {
+            setScore(total - total / 2, total / 2);
+            uint8_t expected = (first + total / SERVE_SWITCH_EVERY) % 2;
+            TEST_ASSERT_EQUAL(expected, game.calculateServingPlayer());
+        }
+    }
+}
+
+static void test_serve_table_matches_reference_rule() {
+    for (uint8_t first = 0; first < 2; first++) {
+        for (uint8_t p1 = 0; p1 < 60; p1++) {
+            for (uint8_t p2 = 0; p2 < 60; p2++) {
+                TEST_ASSERT_EQUAL(tables::computeServingPlayer<Classic21>(p1, p2, first),
+                                  tables::servingPlayer<Classic21>(p1, p2, first));
+            }
+        }
+    }
+}
+
+static void test_add_point_flags_serve_change() {
+    for (int i = 0; i < SERVE_SWITCH_EVERY - 1; i++) {
+        TEST_ASSERT_FALSE(game.addPoint(i % 2));
+        TEST_ASSERT_TRUE(game.state == GameState::PLAYING);
+    }
+    TEST_ASSERT_TRUE(game.addPoint(0));
+    TEST_ASSERT_TRUE(game.state == GameState::SERVE_CHANGE);
+    TEST_ASSERT_EQUAL(1, game.servingPlayer);
+    TEST_ASSERT_EQUAL(1000, game.animStartTime);
+}
+
+static void test_add_point_ignored_outside_playing() {
+    game.state = GameState::SERVE_CHANGE;
+    TEST_ASSERT_FALSE(game.addPoint(0));
+    TEST_ASSERT_EQUAL(0, game.score[0]);
+
+    game.state = GameState::PLAYING;
+    TEST_ASSERT_FALSE(game.addPoint(2));
+    TEST_ASSERT_EQUAL(0, game.totalPoints());
+}
+
+static void test_trailing_player_serves_at_game_point() {
+    setScore(POINTS_TO_WIN - 1, 15);
+    TEST_ASSERT_TRUE(game.isGamePoint());
+    TEST_ASSERT_EQUAL(1, game.calculateServingPlayer());
+
+    setScore(12, POINTS_TO_WIN - 1);
+    TEST_ASSERT_EQUAL(0, game.calculateServingPlayer());
+}
+
+static void test_deuce_serve() {
+    uint16_t blocksBeforeDeuce = (2 * DEUCE_THRESHOLD) / SERVE_SWITCH_EVERY;
+
+    // Tied: alternate every DEUCE_SERVE_SWITCH points
+    setScore(DEUCE_THRESHOLD, DEUCE_THRESHOLD);
+    TEST_ASSERT_TRUE(game.isDeuce());
+    TEST_ASSERT_FALSE(game.isGamePoint());
+    TEST_ASSERT_EQUAL(blocksBeforeDeuce % 2, game.calculateServingPlayer());
+
+    setScore(DEUCE_THRESHOLD + 1, DEUCE_THRESHOLD + 1);
+    TEST_ASSERT_EQUAL((blocksBeforeDeuce + 2 / DEUCE_SERVE_SWITCH) % 2,
+                      game.calculateServingPlayer());
+
+    // Advantage: the other player serves
+    setScore(DEUCE_THRESHOLD + 1, DEUCE_THRESHOLD);
+    TEST_ASSERT_EQUAL(1, game.calculateServingPlayer());
+    setScore(DEUCE_THRESHOLD, DEUCE_THRESHOLD + 1);
+    TEST_ASSERT_EQUAL(0, game.calculateServingPlayer());
+}
+
+static void test_is_game_won() {
+    setScore(POINTS_TO_WIN, 0);
+    TEST_ASSERT_TRUE(game.isGameWon());
+    TEST_ASSERT_EQUAL(0, game.winner());
+
+    setScore(POINTS_TO_WIN - 2, POINTS_TO_WIN);
+    TEST_ASSERT_TRUE(game.isGameWon());
+    TEST_ASSERT_EQUAL(1, game.winner());
+
+    setScore(POINTS_TO_WIN - 1, POINTS_TO_WIN - 1);
+    TEST_ASSERT_FALSE(game.isGameWon());
+    TEST_ASSERT_EQUAL(-1, game.winner());
+
+    // Deuce: must win by WIN_BY
+    setScore(POINTS_TO_WIN, POINTS_TO_WIN - 1);
+    TEST_ASSERT_FALSE(game.isGameWon());
+    setScore(POINTS_TO_WIN + 1, POINTS_TO_WIN - 1);
+    TEST_ASSERT_TRUE(game.isGameWon());
+    setScore(30, 31);
+    TEST_ASSERT_FALSE(game.isGameWon());
+    setScore(30, 32);
+    TEST_ASSERT_TRUE(game.isGameWon());
+}
+
+static void test_winning_point_ends_game() {
+    setScore(POINTS_TO_WIN - 1, 3);
+    TEST_ASSERT_FALSE(game.addPoint(0));
+    TEST_ASSERT_TRUE(game.state == GameState::GAME_OVER);
+    TEST_ASSERT_EQUAL(0, game.winner());
+}
+
+static void test_remove_point_undoes_score_and_serve() {
+    setScore(4, 0);
+    TEST_ASSERT_TRUE(game.addPoint(1));   // 4-1: serve moves to P2
+    game.state = GameState::PLAYING;      // Serve animation finished
+    game.removePoint(1);
+    TEST_ASSERT_EQUAL(4, game.score[0]);
+    TEST_ASSERT_EQUAL(0, game.score[1]);
+    TEST_ASSERT_EQUAL(0, game.servingPlayer);
+}
+
+static void test_remove_point_reverts_game_over() {
+    setScore(POINTS_TO_WIN - 1, 10);
+    game.addPoint(0);
+    TEST_ASSERT_TRUE(game.state == GameState::GAME_OVER);
+
+    game.removePoint(0);
+    TEST_ASSERT_TRUE(game.state == GameState::PLAYING);
+    TEST_ASSERT_FALSE(game.isGameWon());
+    TEST_ASSERT_EQUAL(POINTS_TO_WIN - 1, game.score[0]);
+}
+
+static void test_remove_point_at_zero_is_noop() {
+    game.removePoint(0);
+    game.removePoint(1);
+    game.removePoint(2);
+    TEST_ASSERT_EQUAL(0, game.totalPoints());
+    TEST_ASSERT_EQUAL(0, game.servingPlayer);
+}
+
+// Score points in order ('1' = P1, '2' = P2), skipping serve animations
+static void play(const char *points) {
+    for (; *points; points++) {
+        game.state = GameState::PLAYING;
+        game.addPoint(*points - '1');
+    }
+}
+
+static void test_stats_follow_points_and_undo() {
+    play("11211122");   // P1 serves the first 5, P2 the next 3
+    TEST_ASSERT_EQUAL(5, game.stats.served[0]);
+    TEST_ASSERT_EQUAL(4, game.stats.held[0]);
+    TEST_ASSERT_EQUAL(3, game.stats.served[1]);
+    TEST_ASSERT_EQUAL(2, game.stats.held[1]);
+    TEST_ASSERT_EQUAL(3, game.stats.longest[0]);
+    TEST_ASSERT_EQUAL(2, game.stats.longest[1]);
+
+    // Taking back P2's run leaves what "112111" alone would have
+    game.removePoint(1);
+    game.removePoint(1);
+    GameStats undone = game.stats;
+    game.reset();
+    play("112111");
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(game.stats.served, undone.served, 2);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(game.stats.held, undone.held, 2);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(game.stats.longest, undone.longest, 2);
+
+    // Without a run history, emptying a run forgets the one before
+    game.reset();
+    play("1112");
+    game.removePoint(1);
+    TEST_ASSERT_EQUAL(NO_PLAYER, game.stats.runPlayer);
+    TEST_ASSERT_EQUAL(3, game.stats.longest[0]);
+
+    // With one, back across run boundaries, every field as if never played
+    RunHistory runs;
+    game.runHistory = &runs;
+    game.reset();
+    play("11121");
+    game.removePoint(0);
+    game.removePoint(1);
+    undone = game.stats;
+    game.reset();
+    play("111");
+    TEST_ASSERT_EQUAL_HEX8_ARRAY((const uint8_t *)&game.stats, (const uint8_t *)&undone, sizeof(GameStats));
+    game.removePoint(0);
+    game.removePoint(0);
+    game.removePoint(0);
+    GameStats cleared;
+    cleared.clear();
+    TEST_ASSERT_EQUAL_HEX8_ARRAY((const uint8_t *)&cleared, (const uint8_t *)&game.stats, sizeof(GameStats));
+    game.runHistory = nullptr;
+
+    // Each tie at deuce counts once
+    setScore(DEUCE_THRESHOLD - 1, DEUCE_THRESHOLD);
+    play("112");
+    TEST_ASSERT_EQUAL(2, game.stats.deuces);
+    game.removePoint(1);
+    TEST_ASSERT_EQUAL(1, game.stats.deuces);
+}
+
+static void test_match_totals_add_finished_games() {
+    MatchStats match;
+    match.clear();
+    play("1211");
+    match.gameFinished(game.stats, 0, 60000);
+    game.reset();
+    play("22");
+    match.gameFinished(game.stats, 1, 120000);
+
+    TEST_ASSERT_EQUAL(2, match.games);
+    TEST_ASSERT_EQUAL(1, match.wins[0]);
+    TEST_ASSERT_EQUAL(1, match.wins[1]);
+    TEST_ASSERT_EQUAL(6, match.served[0]);
+    TEST_ASSERT_EQUAL(3, match.held[0]);
+    TEST_ASSERT_EQUAL(2, match.longest[0]);
+    TEST_ASSERT_EQUAL(2, match.longest[1]);
+    TEST_ASSERT_EQUAL(90000, match.averageMs());
+    TEST_ASSERT_EQUAL(50, percentOf(match.held[0], match.served[0]));
+}
+
+static void test_ittf_rules() {
+    IttfGame ittf;
+    ittf.reset();
+    TEST_ASSERT_TRUE(ittf.rules == RuleSet::ITTF_11);
+
+    // Serve every 2 points, no trailing-player rule at game point
+    ittf.setScore(10, 4);
+    TEST_ASSERT_TRUE(ittf.isGamePoint());
+    TEST_ASSERT_EQUAL(1, ittf.servingPlayer);   // 14 points: 7th block
+    ittf.setScore(11, 9);
+    TEST_ASSERT_EQUAL(0, ittf.winner());
+
+    // Deuce from 10-10: alternate every point, win by 2
+    ittf.setScore(10, 10);
+    TEST_ASSERT_TRUE(ittf.isDeuce());
+    uint8_t server = ittf.servingPlayer;
+    ittf.state = GameState::PLAYING;
+    TEST_ASSERT_TRUE(ittf.addPoint(0));
+    TEST_ASSERT_EQUAL(1 - server, ittf.servingPlayer);
+    TEST_ASSERT_FALSE(ittf.isGameWon());
+    ittf.state = GameState::PLAYING;
+    ittf.addPoint(0);
+    TEST_ASSERT_EQUAL(0, ittf.winner());
+
+    for (uint8_t first = 0; first < 2; first++) {
+        for (uint8_t p1 = 0; p1 < 40; p1++) {
+            for (uint8_t p2 = 0; p2 < 40; p2++) {
+                TEST_ASSERT_EQUAL(tables::computeServingPlayer<Ittf11>(p1, p2, first),
+                                  tables::servingPlayer<Ittf11>(p1, p2, first));
+            }
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reset_starts_at_love_with_p1_serving);
+    RUN_TEST(test_serve_rotates_every_serve_switch_points);
+    RUN_TEST(test_serve_table_matches_reference_rule);
+    RUN_TEST(test_add_point_flags_serve_change);
+    RUN_TEST(test_add_point_ignored_outside_playing);
+    RUN_TEST(test_trailing_player_serves_at_game_point);
+    RUN_TEST(test_deuce_serve);
+    RUN_TEST(test_is_game_won);
+    RUN_TEST(test_winning_point_ends_game);
+    RUN_TEST(test_remove_point_undoes_score_and_serve);
+    RUN_TEST(test_remove_point_reverts_game_over);
+    RUN_TEST(test_remove_point_at_zero_is_noop);
+    RUN_TEST(test_stats_follow_points_and_undo);
+    RUN_TEST(test_match_totals_add_finished_games);
+    RUN_TEST(test_ittf_rules);
+    return UNITY_END();
+}
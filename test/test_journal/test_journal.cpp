@@ -0,0 +1,209 @@
+// =============================================================================
+// PointJournal undo / replay tests (pio test -e native -f test_journal)
+// =============================================================================
+
+#include <unity.h>
+#include "journal.h"
+
+static PingPongGame game;
+static PingPongGame replayed;
+static PointJournal journal;
+
+void setUp() {
+    shimSetMillis(1000);
+    game.reset();
+    journal.startGame(game.firstServer);
+}
+
+void tearDown() {}
+
+// Score a point live and in the journal, skipping serve-change animations
+static void play(uint8_t player) {
+    game.state = GameState::PLAYING;
+    game.addPoint(player);
+    journal.recordPoint(player);
+    shimAdvanceMillis(4000);
+}
+
+static void assertReplayMatches(const PingPongGame& expected) {
+    journal.replay(replayed);
+    TEST_ASSERT_EQUAL(expected.score[0], replayed.score[0]);
+    TEST_ASSERT_EQUAL(expected.score[1], replayed.score[1]);
+    TEST_ASSERT_EQUAL(expected.firstServer, replayed.firstServer);
+    TEST_ASSERT_EQUAL(expected.servingPlayer, replayed.servingPlayer);
+}
+
+static void test_replay_matches_live_play() {
+    game.swapFirstServer();
+    journal.recordSwap();
+    for (int i = 0; i < 45; i++) {
+        play((i * 7 / 3) & 1);
+        if (game.isGameWon()) break;
+        assertReplayMatches(game);
+    }
+}
+
+static void test_undo_point_removes_that_players_latest_point() {
+    play(0);
+    play(0);
+    play(1);
+    play(0);
+
+    // P2's only point was not the last event
+    TEST_ASSERT_TRUE(journal.undoPoint(1));
+    journal.replay(game);
+    TEST_ASSERT_EQUAL(3, game.score[0]);
+    TEST_ASSERT_EQUAL(0, game.score[1]);
+
+    TEST_ASSERT_FALSE(journal.undoPoint(1));
+    TEST_ASSERT_EQUAL(3, journal.size());
+}
+
+static void test_undo_restores_serve_after_swap() {
+    game.swapFirstServer();
+    journal.recordSwap();
+    for (int i = 0; i < SERVE_SWITCH_EVERY; i++) play(0);
+    TEST_ASSERT_EQUAL(0, game.servingPlayer);  // P2 served the first block
+
+    // Undo everything: back to 0-0 with P2 still serving first
+    while (journal.undoPoint(0)) {}
+    journal.replay(game);
+    TEST_ASSERT_EQUAL(0, game.totalPoints());
+    TEST_ASSERT_EQUAL(1, game.firstServer);
+    TEST_ASSERT_EQUAL(1, game.servingPlayer);
+
+    // Undo the swap itself
+    TEST_ASSERT_TRUE(journal.undo());
+    journal.replay(game);
+    TEST_ASSERT_EQUAL(0, game.firstServer);
+}
+
+// A speculative tap that won the game, taken back as a double tap: the game
+// returns to play at the old score, with the journal as before the tap
+static void test_taken_back_winning_tap_resumes_play() {
+    for (int i = 0; i < POINTS_TO_WIN - 1; i++) play(0);
+    uint16_t events = journal.size();
+
+    game.addPoint(0);
+    journal.recordPoint(0);
+    TEST_ASSERT_EQUAL(GameState::GAME_OVER, game.state);
+
+    TEST_ASSERT_TRUE(journal.undoPoint(0));
+    journal.replay(game);
+    TEST_ASSERT_EQUAL(GameState::PLAYING, game.state);
+    TEST_ASSERT_FALSE(game.isGameWon());
+    TEST_ASSERT_EQUAL(POINTS_TO_WIN - 1, game.score[0]);
+    TEST_ASSERT_EQUAL(events, journal.size());
+}
+
+static void test_undo_of_reset_restores_the_game() {
+    play(0);
+    play(1);
+    play(1);
+    journal.recordReset();
+    journal.replay(game);
+    TEST_ASSERT_EQUAL(0, game.totalPoints());
+
+    // Undo-point can't reach past the reset; a plain undo removes it
+    TEST_ASSERT_FALSE(journal.undoPoint(1));
+    TEST_ASSERT_TRUE(journal.undo());
+    journal.replay(game);
+    TEST_ASSERT_EQUAL(1, game.score[0]);
+    TEST_ASSERT_EQUAL(2, game.score[1]);
+}
+
+static void test_full_journal_folds_into_base() {
+    // A long deuce: alternate points well past JOURNAL_CAPACITY events
+    PingPongGame live;
+    live.reset();
+    for (int i = 0; i < JOURNAL_CAPACITY + 40; i++) {
+        uint8_t p = i & 1;
+        live.state = GameState::PLAYING;
+        live.addPoint(p);
+        journal.recordPoint(p);
+    }
+    TEST_ASSERT_EQUAL(JOURNAL_CAPACITY, journal.size());
+    assertReplayMatches(live);
+
+    // Points older than the window come off the base score
+    for (int i = 0; i < JOURNAL_CAPACITY / 2 + 5; i++) TEST_ASSERT_TRUE(journal.undoPoint(0));
+    journal.replay(game);
+    TEST_ASSERT_EQUAL(live.score[0] - (JOURNAL_CAPACITY / 2 + 5), game.score[0]);
+    TEST_ASSERT_EQUAL(live.score[1], game.score[1]);
+}
+
+static void test_records_pack_time_deltas() {
+    shimSetMillis(1000);
+    journal.startGame(0);
+    shimAdvanceMillis(2500);
+    journal.recordPoint(1);
+    shimAdvanceMillis(3600000);   // An hour: saturates
+    journal.recordPoint(0);
+
+    TEST_ASSERT_EQUAL(2, journal.size());
+    TEST_ASSERT_TRUE(PointJournal::type(journal.raw(0)) == JournalEvent::POINT_P2);
+    TEST_ASSERT_EQUAL(2500 / JOURNAL_TICK_MS, PointJournal::deltaTicks(journal.raw(0)));
+    TEST_ASSERT_EQUAL(PointJournal::MAX_DELTA, PointJournal::deltaTicks(journal.raw(1)));
+    TEST_ASSERT_TRUE(sizeof(PointJournal) <= 2 * JOURNAL_CAPACITY + 32);
+}
+
+static void test_rules_survive_save_and_load() {
+    journal.startRules(RuleSet::ITTF_11, 1);
+    journal.recordPoint(0);
+    JournalImage img;
+    journal.save(img);
+
+    PointJournal loaded;
+    TEST_ASSERT_TRUE(loaded.load(img));
+    TEST_ASSERT_TRUE(loaded.rules() == RuleSet::ITTF_11);
+    IttfGame ittf;
+    loaded.replay(ittf);
+    TEST_ASSERT_EQUAL(1, ittf.score[0]);
+    TEST_ASSERT_EQUAL(1, ittf.firstServer);
+
+    img.rules = RULE_SET_COUNT;
+    TEST_ASSERT_FALSE(loaded.load(img));
+}
+
+// A game restored already won has no known length: the match average
+// stays that of the games timed from 0-0
+static void test_restored_win_adds_no_length() {
+    GameClock clock;
+    MatchStats match;
+    match.clear();
+    clock.start(millis());
+    while (!game.isGameWon()) play(0);
+    clock.won(millis());
+    match.gameFinished(game.stats, game.winner(), clock.durationMs());
+    TEST_ASSERT_EQUAL_UINT32(POINTS_TO_WIN * 4000UL, match.averageMs());
+
+    // Reboot with the clock starting over, then restore as setupTable() does
+    JournalImage img;
+    journal.save(img);
+    shimSetMillis(500);
+    PointJournal restored;
+    TEST_ASSERT_TRUE(restored.load(img));
+    restored.replay(replayed);
+    TEST_ASSERT_TRUE(replayed.isGameWon());
+    clock.start(millis());
+    if (replayed.totalPoints() != 0) clock.forget();
+    match.gameFinished(replayed.stats, replayed.winner(), clock.durationMs());
+
+    TEST_ASSERT_EQUAL(2, match.games);
+    TEST_ASSERT_EQUAL(1, match.timedGames);
+    TEST_ASSERT_EQUAL_UINT32(POINTS_TO_WIN * 4000UL, match.averageMs());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_matches_live_play);
+    RUN_TEST(test_undo_point_removes_that_players_latest_point);
+    RUN_TEST(test_undo_restores_serve_after_swap);
+    RUN_TEST(test_taken_back_winning_tap_resumes_play);
+    RUN_TEST(test_undo_of_reset_restores_the_game);
+    RUN_TEST(test_full_journal_folds_into_base);
+    RUN_TEST(test_records_pack_time_deltas);
+    RUN_TEST(test_rules_survive_save_and_load);
+    RUN_TEST(test_restored_win_adds_no_length);
+    return UNITY_END();
+}
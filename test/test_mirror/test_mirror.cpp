@@ -0,0 +1,195 @@
+// =============================================================================
+// Mirror display protocol tests (pio test -e native -f test_mirror)
+// =============================================================================
+// The primary's MirrorEncoder and a mirror's MirrorFollower, joined by a
+// "radio" that can lose or repeat packets.
+
+#include <unity.h>
+#include "mirror.h"
+
+static PingPongGame primary;
+static PingPongGame mirror;
+static MirrorEncoder encoder;
+static MirrorFollower follower;
+
+void setUp() {
+    shimSetMillis(1000);
+    primary.reset();
+    mirror.reset();
+    encoder = MirrorEncoder();
+    follower = MirrorFollower(0);
+}
+
+void tearDown() {}
+
+// What the network task would broadcast after the primary's last change
+static bool send(MirrorPacket& p) {
+    return encoder.update(primary, 0, millis(), p);
+}
+
+// Primary scores, the mirror hears it
+static MirrorApply point(uint8_t player) {
+    if (primary.state == GameState::SERVE_CHANGE) primary.state = GameState::PLAYING;
+    primary.addPoint(player);
+    MirrorPacket p;
+    TEST_ASSERT_TRUE(send(p));
+    return follower.apply(p, mirror);
+}
+
+// Mirror hears the primary's first keyframe
+static void connect() {
+    MirrorPacket p;
+    TEST_ASSERT_TRUE(send(p));
+    follower.apply(p, mirror);
+    TEST_ASSERT_TRUE(follower.synced());
+}
+
+static void assertMirrored() {
+    TEST_ASSERT_EQUAL_UINT8(primary.score[0], mirror.score[0]);
+    TEST_ASSERT_EQUAL_UINT8(primary.score[1], mirror.score[1]);
+    TEST_ASSERT_EQUAL_UINT8(primary.servingPlayer, mirror.servingPlayer);
+    TEST_ASSERT_EQUAL_INT8(primary.winner(), mirror.winner());
+}
+
+static void test_wire_layout() {
+    primary.setScore(7, 5);
+    primary.firstServer = 1;
+    MirrorPacket p;
+    TEST_ASSERT_TRUE(send(p));
+
+    const uint8_t expected[16] = {
+        0x4D, 0x52, MIRROR_PACKET_VERSION, (uint8_t)MirrorKind::KEYFRAME,
+        0x01, 0x00, 0x00, 0x00,
+        0, 0, 7, 5,
+        1, (uint8_t)RuleSet::CLASSIC_21, 0, 0
+    };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, (const uint8_t *)&p, sizeof(expected));
+    TEST_ASSERT_TRUE(p.valid());
+}
+
+static void test_points_play_as_deltas() {
+    MirrorPacket p;
+    TEST_ASSERT_TRUE(send(p));   // Keyframe at 0-0
+    TEST_ASSERT_EQUAL(MirrorApply::IGNORED, follower.apply(p, mirror));  // Already 0-0
+    TEST_ASSERT_TRUE(follower.synced());
+
+    // Through serve changes and on to the win, animations included
+    for (uint8_t i = 0; primary.state != GameState::GAME_OVER; i++) {
+        TEST_ASSERT_EQUAL(MirrorApply::DELTA, point(i % 5 == 0 ? 1 : 0));
+        assertMirrored();
+        TEST_ASSERT_EQUAL(primary.state, mirror.state);
+        TEST_ASSERT_EQUAL_UINT32(primary.animStartTime, mirror.animStartTime);
+    }
+    TEST_ASSERT_EQUAL(GameState::GAME_OVER, mirror.state);
+    TEST_ASSERT_EQUAL_UINT32(0, follower.resyncs());
+}
+
+static void test_undo_is_a_delta() {
+    connect();
+    point(0);
+    point(1);
+    primary.removePoint(1);
+    MirrorPacket p;
+    TEST_ASSERT_TRUE(send(p));
+    TEST_ASSERT_EQUAL((uint8_t)MirrorKind::UNPOINT, p.kind);
+    TEST_ASSERT_EQUAL(MirrorApply::DELTA, follower.apply(p, mirror));
+    assertMirrored();
+}
+
+static void test_lost_packet_resyncs() {
+    connect();
+    point(0);
+    primary.addPoint(1);
+    MirrorPacket lost;
+    send(lost);                  // Never arrives
+
+    TEST_ASSERT_EQUAL(MirrorApply::RESYNC, point(1));
+    assertMirrored();
+    TEST_ASSERT_EQUAL(GameState::PLAYING, mirror.state);   // No serve animation replayed
+    TEST_ASSERT_EQUAL_UINT32(1, follower.resyncs());
+
+    TEST_ASSERT_EQUAL(MirrorApply::DELTA, point(0));       // Back in step
+}
+
+static void test_duplicate_and_late_packets_ignored() {
+    connect();
+    primary.addPoint(0);
+    MirrorPacket first;
+    send(first);
+    TEST_ASSERT_EQUAL(MirrorApply::DELTA, follower.apply(first, mirror));
+    point(0);
+
+    TEST_ASSERT_EQUAL(MirrorApply::IGNORED, follower.apply(first, mirror));
+    assertMirrored();
+
+    MirrorPacket other = first;
+    other.table = 1;
+    TEST_ASSERT_EQUAL(MirrorApply::IGNORED, follower.apply(other, mirror));
+    other = first;
+    other.magic = 0;
+    TEST_ASSERT_FALSE(other.valid());
+}
+
+static void test_keyframe_heartbeat() {
+    connect();
+    MirrorPacket p;
+
+    shimAdvanceMillis(MIRROR_KEYFRAME_MS - 1);
+    TEST_ASSERT_FALSE(send(p));  // Nothing new yet
+    shimAdvanceMillis(1);
+    TEST_ASSERT_TRUE(send(p));
+    TEST_ASSERT_EQUAL((uint8_t)MirrorKind::KEYFRAME, p.kind);
+
+    // A mirror that missed the last change catches up on the keyframe
+    primary.addPoint(1);
+    MirrorPacket lost;
+    send(lost);
+    shimAdvanceMillis(MIRROR_KEYFRAME_MS);
+    TEST_ASSERT_TRUE(send(p));
+    TEST_ASSERT_EQUAL(MirrorApply::RESYNC, follower.apply(p, mirror));
+    assertMirrored();
+    TEST_ASSERT_EQUAL_UINT32(0, follower.silentMs());
+}
+
+static void test_new_game_resyncs() {
+    primary.setScore(POINTS_TO_WIN - 1, 2);
+    connect();
+    MirrorPacket p;
+    TEST_ASSERT_EQUAL(MirrorApply::DELTA, point(0));
+    TEST_ASSERT_EQUAL(GameState::GAME_OVER, mirror.state);
+
+    // Next game, loser serves first: not a delta
+    primary.reset();
+    primary.firstServer = 1;
+    primary.servingPlayer = 1;
+    TEST_ASSERT_TRUE(send(p));
+    TEST_ASSERT_EQUAL((uint8_t)MirrorKind::KEYFRAME, p.kind);
+    TEST_ASSERT_EQUAL(MirrorApply::RESYNC, follower.apply(p, mirror));
+    TEST_ASSERT_EQUAL(GameState::PLAYING, mirror.state);
+    assertMirrored();
+}
+
+static void test_joining_mid_game_game_over() {
+    primary.setScore(POINTS_TO_WIN, 4);
+    primary.state = GameState::GAME_OVER;
+    MirrorPacket p;
+    send(p);
+    TEST_ASSERT_EQUAL(MirrorApply::RESYNC, follower.apply(p, mirror));
+    TEST_ASSERT_EQUAL(GameState::GAME_OVER, mirror.state);
+    // Straight to the final score, not the victory animation
+    TEST_ASSERT_TRUE(millis() - mirror.animStartTime > VICTORY_ANIM_MS);
+    assertMirrored();
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_wire_layout);
+    RUN_TEST(test_points_play_as_deltas);
+    RUN_TEST(test_undo_is_a_delta);
+    RUN_TEST(test_lost_packet_resyncs);
+    RUN_TEST(test_duplicate_and_late_packets_ignored);
+    RUN_TEST(test_keyframe_heartbeat);
+    RUN_TEST(test_new_game_resyncs);
+    RUN_TEST(test_joining_mid_game_game_over);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+// =============================================================================
+// StatePacket wire format tests (pio test -e native -f test_packet)
+// =============================================================================
+// Receivers parse the documented byte offsets directly, so the layout is
+// checked byte by byte.
+
+#include <unity.h>
+#include "statepacket.h"
+#include "statejson.h"
+
+static PingPongGame game;
+
+void setUp() {
+    shimSetMillis(1000);
+    game.reset();
+}
+
+void tearDown() {}
+
+static void test_wire_layout() {
+    game.setScore(21, 20);
+    game.servingPlayer = 1;
+    game.state = GameState::SERVE_CHANGE;
+
+    StatePacket p;
+    p.fill(game, 1);
+    p.seq = 0x01020304;
+
+    const uint8_t expected[14] = {
+        0x50, 0x50, STATE_PACKET_VERSION, STATE_FLAG_DEUCE,
+        0x04, 0x03, 0x02, 0x01,
+        21, 20, 1, 1,
+        1, (uint8_t)RuleSet::CLASSIC_21
+    };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, (const uint8_t *)&p, sizeof(expected));
+}
+
+static void test_rules_byte() {
+    IttfGame ittf;
+    ittf.reset();
+    StatePacket p, q;
+    p.fill(game);
+    q.fill(ittf);
+    TEST_ASSERT_EQUAL_HEX8((uint8_t)RuleSet::CLASSIC_21, ((const uint8_t *)&p)[13]);
+    TEST_ASSERT_EQUAL_HEX8((uint8_t)RuleSet::ITTF_11, ((const uint8_t *)&q)[13]);
+
+    // Same score under other rules is a new state
+    TEST_ASSERT_FALSE(p.sameState(q));
+}
+
+static void test_game_point_flag() {
+    game.setScore(POINTS_TO_WIN - 1, 3);
+    StatePacket p;
+    p.fill(game);
+    TEST_ASSERT_EQUAL_HEX8(STATE_FLAG_GAME_POINT, p.flags);
+}
+
+static void test_same_state_ignores_seq_and_heartbeat() {
+    StatePacket a, b;
+    a.fill(game);
+    b.fill(game);
+    a.seq = 1;
+    b.seq = 2;
+    b.flags |= STATE_FLAG_HEARTBEAT;
+    TEST_ASSERT_TRUE(a.sameState(b));
+
+    game.addPoint(0);
+    b.fill(game);
+    TEST_ASSERT_FALSE(a.sameState(b));
+}
+
+static void test_stats_bytes() {
+    game.addPoint(0);
+    game.addPoint(0);
+    game.addPoint(1);
+    MatchStats match;
+    match.clear();
+    match.wins[1] = 300;
+    match.games = 2;
+    match.timedGames = 2;
+    match.totalMs = 600000;
+
+    StatePacket p;
+    p.fill(game, 0, &match);
+    const uint8_t expected[12] = {
+        3, 0,       // served
+        2, 0,       // held
+        2, 1,       // longest
+        0,          // deuces
+        0, 255,     // wins (saturated)
+        0x2C, 0x01, // 300 s average
+        0
+    };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, (const uint8_t *)&p + 14, sizeof(expected));
+
+    // A stats change alone is a new state
+    StatePacket q;
+    match.wins[0] = 1;
+    q.fill(game, 0, &match);
+    TEST_ASSERT_FALSE(p.sameState(q));
+}
+
+static void test_metrics_offsets() {
+    TEST_ASSERT_EQUAL(4, offsetof(MetricsPacket, seq));
+    TEST_ASSERT_EQUAL(8, offsetof(MetricsPacket, uptimeS));
+    TEST_ASSERT_EQUAL(12, offsetof(MetricsPacket, freeHeap));
+    TEST_ASSERT_EQUAL(16, offsetof(MetricsPacket, minFreeHeap));
+    TEST_ASSERT_EQUAL(20, offsetof(MetricsPacket, largestBlock));
+    TEST_ASSERT_EQUAL(24, offsetof(MetricsPacket, stackFree));
+}
+
+static void test_dashboard_event_text() {
+    game.setScore(21, 20);
+    game.servingPlayer = 1;
+    game.state = GameState::SERVE_CHANGE;
+
+    char buf[WEB_EVENT_SIZE];
+    size_t len = formatStateEvent(buf, sizeof(buf), 7, &game, 1);
+    TEST_ASSERT_EQUAL_STRING(
+        "id: 7\ndata: {\"tables\":[{\"table\":1,\"rules\":\"21 point classic\",\"p1\":21,\"p2\":20,"
+        "\"serve\":2,\"state\":\"serve_change\",\"deuce\":true,\"gamePoint\":false,\"winner\":0}]}\n\n",
+        buf);
+    TEST_ASSERT_EQUAL(strlen(buf), len);
+
+    // Too small: nothing, rather than half an event
+    TEST_ASSERT_EQUAL(0, formatStateEvent(buf, 40, 7, &game, 1));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_wire_layout);
+    RUN_TEST(test_rules_byte);
+    RUN_TEST(test_game_point_flag);
+    RUN_TEST(test_same_state_ignores_seq_and_heartbeat);
+    RUN_TEST(test_stats_bytes);
+    RUN_TEST(test_metrics_offsets);
+    RUN_TEST(test_dashboard_event_text);
+    return UNITY_END();
+}
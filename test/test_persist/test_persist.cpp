@@ -0,0 +1,129 @@
+// =============================================================================
+// MatchStore persistence tests (pio test -e native -f test_persist)
+// =============================================================================
+// A "reboot" is a fresh MatchStore and PointJournal over the same RTC image
+// and (shim) NVS contents.
+
+#include <unity.h>
+#include "persist.h"
+
+static MatchImage rtc;
+static PointJournal journal;
+static PingPongGame game;
+
+void setUp() {
+    shimSetMillis(1000);
+    g_shimNvs.clear();
+    g_shimNvsWrites = 0;
+    memset(&rtc, 0xA5, sizeof(rtc));   // RTC_NOINIT garbage after power-on
+    game.reset();
+    journal.startGame(0);
+}
+
+void tearDown() {}
+
+static void play(MatchStore& store, uint8_t player) {
+    game.state = GameState::PLAYING;
+    game.addPoint(player);
+    journal.recordPoint(player);
+    store.save(journal);
+}
+
+// Restore into a fresh journal/game as setup() would
+static RestoreSource reboot(PingPongGame& out) {
+    MatchStore store;
+    PointJournal restored;
+    store.begin(&rtc);
+    RestoreSource src = store.restore(restored);
+    out.reset();
+    if (src != RestoreSource::NONE) restored.replay(out);
+    return src;
+}
+
+static void test_power_on_garbage_is_ignored() {
+    PingPongGame out;
+    TEST_ASSERT_TRUE(reboot(out) == RestoreSource::NONE);
+}
+
+static void test_soft_reset_restores_from_rtc_without_flash_write() {
+    MatchStore store;
+    store.begin(&rtc);
+    play(store, 0);
+    play(store, 1);
+    play(store, 0);
+    TEST_ASSERT_EQUAL(0, g_shimNvsWrites);
+
+    PingPongGame out;
+    TEST_ASSERT_TRUE(reboot(out) == RestoreSource::RTC);
+    TEST_ASSERT_EQUAL(2, out.score[0]);
+    TEST_ASSERT_EQUAL(1, out.score[1]);
+    TEST_ASSERT_EQUAL(game.servingPlayer, out.servingPlayer);
+}
+
+static void test_burst_of_changes_is_one_nvs_commit() {
+    MatchStore store;
+    store.begin(&rtc);
+    for (int i = 0; i < 6; i++) {
+        play(store, i & 1);
+        shimAdvanceMillis(300);
+        store.service();
+    }
+    TEST_ASSERT_EQUAL(0, g_shimNvsWrites);   // Still inside the quiet window
+
+    shimAdvanceMillis(PERSIST_QUIET_MS);
+    store.service();
+    store.service();
+    TEST_ASSERT_EQUAL(1, g_shimNvsWrites);
+    TEST_ASSERT_EQUAL(1, store.commits());
+
+    // Score then undo back to the committed state: no rewrite
+    play(store, 0);
+    journal.undo();
+    store.save(journal);
+    store.service();
+    shimAdvanceMillis(PERSIST_QUIET_MS);
+    store.service();
+    TEST_ASSERT_EQUAL(1, g_shimNvsWrites);
+    TEST_ASSERT_EQUAL(1, store.skipped());
+}
+
+static void test_power_loss_restores_from_nvs() {
+    MatchStore store;
+    store.begin(&rtc);
+    for (int i = 0; i < 9; i++) play(store, i % 3 == 0);
+    store.service();
+    shimAdvanceMillis(PERSIST_QUIET_MS);
+    store.service();
+
+    memset(&rtc, 0xA5, sizeof(rtc));
+    PingPongGame out;
+    TEST_ASSERT_TRUE(reboot(out) == RestoreSource::NVS);
+    TEST_ASSERT_EQUAL(game.score[0], out.score[0]);
+    TEST_ASSERT_EQUAL(game.score[1], out.score[1]);
+}
+
+static void test_corrupt_rtc_falls_back_to_nvs() {
+    MatchStore store;
+    store.begin(&rtc);
+    play(store, 1);
+    store.flush();
+    store.service();
+    shimAdvanceMillis(PERSIST_QUIET_MS);
+    store.service();
+    play(store, 1);   // RTC only
+
+    rtc.journal.records[0] ^= 0x0100;
+    PingPongGame out;
+    TEST_ASSERT_TRUE(reboot(out) == RestoreSource::NVS);
+    TEST_ASSERT_EQUAL(1, out.score[1]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_power_on_garbage_is_ignored);
+    RUN_TEST(test_soft_reset_restores_from_rtc_without_flash_write);
+    RUN_TEST(test_burst_of_changes_is_one_nvs_commit);
+    RUN_TEST(test_power_loss_restores_from_nvs);
+    RUN_TEST(test_corrupt_rtc_falls_back_to_nvs);
+    return UNITY_END();
+}
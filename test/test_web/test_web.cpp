@@ -0,0 +1,106 @@
+// =============================================================================
+// Web dashboard stream tests (pio test -e native -f test_web)
+// =============================================================================
+// WebDashboard over the in-memory sockets of test/shims/WiFi.h: what a
+// browser on /events actually receives, including one that reads slowly.
+
+#include <unity.h>
+#include "webview.h"
+
+static WebDashboard web;
+static PingPongGame game;
+
+void setUp() {
+    shimSetMillis(1000);
+    game.reset();
+    web.begin();
+}
+
+void tearDown() {}
+
+static const char *STREAM_HEADER_END = "retry: 2000\n\n";
+
+// Open /events and take the response header; returns the fd
+static int openStream() {
+    int fd = shimConnect("GET /events HTTP/1.1\r\nHost: x\r\n\r\n");
+    web.handle();   // Accept, read the request, send the header
+    std::string& sent = shimSocket(fd).sent;
+    size_t end = sent.find(STREAM_HEADER_END);
+    TEST_ASSERT_TRUE(end != std::string::npos);
+    sent.erase(0, end + strlen(STREAM_HEADER_END));
+    return fd;
+}
+
+static std::string eventText(uint32_t id) {
+    char buf[WEB_EVENT_SIZE];
+    size_t len = formatStateEvent(buf, sizeof(buf), id, &game, 1);
+    return std::string(buf, len);
+}
+
+static void test_stream_gets_each_change() {
+    int fd = openStream();
+    game.setScore(1, 0);
+    web.publish(&game, 1);
+    web.handle();
+    TEST_ASSERT_EQUAL_STRING(eventText(web.events()).c_str(), shimSocket(fd).sent.c_str());
+    shimSocket(fd).open = false;
+    web.handle();
+}
+
+// A viewer still sending an older event must get it intact, however often
+// the same state is published meanwhile
+static void test_repeat_publish_leaves_slow_viewer_intact() {
+    int fd = openStream();
+    ShimSocket& sock = shimSocket(fd);
+
+    game.setScore(3, 2);
+    web.publish(&game, 1);
+    std::string first = eventText(web.events());
+    sock.budget = 10;
+    web.handle();                   // Mid-way through the first event
+
+    game.setScore(4, 2);
+    web.publish(&game, 1);          // Second event in the other buffer
+    std::string second = eventText(web.events());
+    uint32_t events = web.events();
+    web.publish(&game, 1);          // Same state twice: nothing new
+    web.publish(&game, 1);
+    TEST_ASSERT_EQUAL_UINT32(events, web.events());
+
+    sock.budget = SIZE_MAX;
+    web.handle();                   // Rest of the first event
+    web.handle();                   // Then the second
+    TEST_ASSERT_TRUE(sock.open);
+    TEST_ASSERT_EQUAL_STRING((first + second).c_str(), sock.sent.c_str());
+    sock.open = false;
+    web.handle();
+}
+
+// Two changes behind: dropped (the browser reconnects), never sent garbage
+static void test_viewer_two_changes_behind_dropped() {
+    int fd = openStream();
+    ShimSocket& sock = shimSocket(fd);
+
+    game.setScore(5, 5);
+    web.publish(&game, 1);
+    std::string first = eventText(web.events());
+    sock.budget = 10;
+    web.handle();
+
+    uint32_t dropped = web.dropped();
+    game.setScore(6, 5);
+    web.publish(&game, 1);
+    game.setScore(6, 6);
+    web.publish(&game, 1);          // Overwrites the buffer it was sending
+    TEST_ASSERT_EQUAL_UINT32(dropped + 1, web.dropped());
+    TEST_ASSERT_FALSE(sock.open);
+    TEST_ASSERT_EQUAL_STRING(first.substr(0, 10).c_str(), sock.sent.c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_gets_each_change);
+    RUN_TEST(test_repeat_publish_leaves_slow_viewer_intact);
+    RUN_TEST(test_viewer_two_changes_behind_dropped);
+    return UNITY_END();
+}